@@ -8,45 +8,37 @@ AABB::AABB()
     // The default AABB is empty, since intervals are empty by default.
 } 
 
-AABB::AABB(const Interval& x, const Interval& y, const Interval& z)
+AABB::AABB(const Interval& x, const Interval& y, const Interval& z) : x(x), y(y), z(z)
 {
-    this->x = make_shared<Interval>(x);
-    this->y = make_shared<Interval>(y);
-    this->z = make_shared<Interval>(z);
     pad_to_minimums();
 }
 
 AABB::AABB(const point3& a, const point3& b)
 {
     // Treat the two points a and b as extrema for the bounding box, so we don't require a particular minimum/maximum coordinate order.
-    x = make_shared<Interval>(std::min(a[0], b[0]), std::max(a[0], b[0]));
-    y = make_shared<Interval>(std::min(a[1], b[1]), std::max(a[1], b[1]));
-    z = make_shared<Interval>(std::min(a[2], b[2]), std::max(a[2], b[2]));
+    x = Interval(std::min(a[0], b[0]), std::max(a[0], b[0]));
+    y = Interval(std::min(a[1], b[1]), std::max(a[1], b[1]));
+    z = Interval(std::min(a[2], b[2]), std::max(a[2], b[2]));
 
     pad_to_minimums();
 }
 
 AABB::AABB(const point3& a, const point3& b, const point3& c)
 {
-    x = make_shared<Interval>(std::min({ a[0], b[0], c[0] }), std::max({ a[0], b[0], c[0] }));
-    y = make_shared<Interval>(std::min({ a[1], b[1], c[1] }), std::max({ a[1], b[1], c[1] }));
-    z = make_shared<Interval>(std::min({ a[2], b[2], c[2] }), std::max({ a[2], b[2], c[2] }));
+    x = Interval(std::min({ a[0], b[0], c[0] }), std::max({ a[0], b[0], c[0] }));
+    y = Interval(std::min({ a[1], b[1], c[1] }), std::max({ a[1], b[1], c[1] }));
+    z = Interval(std::min({ a[2], b[2], c[2] }), std::max({ a[2], b[2], c[2] }));
 
     pad_to_minimums();
 }
 
 
 AABB::AABB(const AABB& box0, const AABB& box1)
-{
     // The interval contructor method automatically orders the interval values
-    x = make_shared<Interval>(*box0.x, *box1.x);
-    y = make_shared<Interval>(*box0.y, *box1.y);
-    z = make_shared<Interval>(*box0.z, *box1.z);
-}
-
-AABB::AABB(const shared_ptr<AABB>& box0, const shared_ptr<AABB>& box1) : AABB(*box0, *box1) {}
+    : x(box0.x, box1.x), y(box0.y, box1.y), z(box0.z, box1.z)
+{}
 
-const shared_ptr<Interval>& AABB::axis_interval(int n) const
+const Interval& AABB::axis_interval(int n) const
 {
     if (n == 1) return y;
     if (n == 2) return z;
@@ -55,26 +47,37 @@ const shared_ptr<Interval>& AABB::axis_interval(int n) const
 
 int AABB::longest_axis() const
 {
-    if (x->size() > y->size())
-        return x->size() > z->size() ? 0 : 2;
+    if (x.size() > y.size())
+        return x.size() > z.size() ? 0 : 2;
     else
-        return y->size() > z->size() ? 1 : 2;
+        return y.size() > z.size() ? 1 : 2;
+}
+
+point3 AABB::centroid() const
+{
+    return point3((x.min + x.max) / 2, (y.min + y.max) / 2, (z.min + z.max) / 2);
+}
+
+double AABB::surface_area() const
+{
+    double dx = x.size(), dy = y.size(), dz = z.size();
+    return 2 * (dx * dy + dy * dz + dz * dx);
 }
 
-bool AABB::hit(const shared_ptr<Ray>& r, Interval ray_t) const
+bool AABB::hit(const Ray& r, Interval ray_t) const
 {
     // ** Slab method ** //
-    const point3& ray_orig = r->origin();
-    const vec3& ray_dir = r->direction();
+    const point3& ray_orig = r.origin();
+    const vec3& ray_dir = r.direction();
 
     for (int axis = 0; axis < 3; axis++)
     {
-        const shared_ptr<Interval>& ax = axis_interval(axis);
+        const Interval& ax = axis_interval(axis);
 
         // Calculate ray intersection with current axis interval extremes
-        const double adinv = 1.0 / ray_dir[axis];
-        auto t0 = (ax->min - ray_orig[axis]) * adinv;
-        auto t1 = (ax->max - ray_orig[axis]) * adinv;
+        const real adinv = 1 / ray_dir[axis];
+        auto t0 = (ax.min - ray_orig[axis]) * adinv;
+        auto t1 = (ax.max - ray_orig[axis]) * adinv;
 
         if (t0 < t1)
         {
@@ -97,11 +100,11 @@ bool AABB::hit(const shared_ptr<Ray>& r, Interval ray_t) const
 void AABB::pad_to_minimums()
 {
     // Adjust the AABB so that no side is narrower than some delta, padding if necessary.
-    if (x->size() < delta) x = make_shared<Interval>(x->expand(delta));
-    if (y->size() < delta) y = make_shared<Interval>(y->expand(delta));
-    if (z->size() < delta) z = make_shared<Interval>(z->expand(delta));
+    if (x.size() < delta) x = x.expand(delta);
+    if (y.size() < delta) y = y.expand(delta);
+    if (z.size() < delta) z = z.expand(delta);
 }
 
 // Static members
-const AABB AABB::empty = AABB(Interval::empty, Interval::empty, Interval::empty);
+const AABB AABB::empty = AABB();    // Padding an empty interval would reorder its bounds into the universe interval
 const AABB AABB::universe = AABB(Interval::universe, Interval::universe, Interval::universe);
\ No newline at end of file
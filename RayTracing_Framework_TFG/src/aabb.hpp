@@ -7,10 +7,10 @@
 // Forward declarations
 class Ray;
 
-class AABB
+class alignas(16) AABB // Flat box of six reals (48 bytes, 32 in single precision) held by value in the primitives, transforms and BVH nodes
 {
 public:
-    shared_ptr<Interval> x, y, z;
+    Interval x, y, z;
     static const AABB empty, universe;
 
     AABB(); 
@@ -18,21 +18,22 @@ public:
     AABB(const point3& a, const point3& b);
     AABB(const point3& a, const point3& b, const point3& c);
     AABB(const AABB& box0, const AABB& box1);
-    AABB(const shared_ptr<AABB>& box0, const shared_ptr<AABB>& box1);
 
-    const shared_ptr<Interval>& axis_interval(int n) const;
+    const Interval& axis_interval(int n) const;
     int longest_axis() const; // Returns the index of the longest axis of the bounding box.
-    bool hit(const shared_ptr<Ray>& r, Interval ray_t) const;
+    point3 centroid() const;
+    double surface_area() const;
+    bool hit(const Ray& r, Interval ray_t) const;
 
 private:
-    double delta = 0.0001;
+    static constexpr real delta = 0.0001;
     void pad_to_minimums();
 };
 
 // Operator overloads
 inline AABB operator+(const AABB& bbox, const vec3& offset)
 {
-    return AABB(*bbox.x + offset.x, *bbox.y + offset.y, *bbox.z + offset.z);
+    return AABB(bbox.x + offset.x, bbox.y + offset.y, bbox.z + offset.z);
 }
 
 inline AABB operator+(const vec3& offset, const AABB& bbox)
@@ -42,7 +43,7 @@ inline AABB operator+(const vec3& offset, const AABB& bbox)
 
 inline AABB operator*(const AABB& bbox, const vec3& offset)
 {
-    return AABB(*bbox.x * offset.x, *bbox.y * offset.y, *bbox.z * offset.z);
+    return AABB(bbox.x * offset.x, bbox.y * offset.y, bbox.z * offset.z);
 }
 
 inline AABB operator*(const vec3& offset, const AABB& bbox)
@@ -0,0 +1,73 @@
+﻿// Headers
+#include "core.hpp"
+#include "arena.hpp"
+
+// Bytes reserved by the arenas of all threads, and the highest value it has reached
+static std::atomic<size_t> reserved_bytes = 0;
+static std::atomic<size_t> peak_reserved = 0;
+
+MemoryArena::MemoryArena(size_t block_size) : block_size(block_size) {}
+
+MemoryArena::~MemoryArena()
+{
+    reserved_bytes -= capacity();
+}
+
+void* MemoryArena::allocate(size_t size, size_t alignment)
+{
+    while (current_block < int(blocks.size()))
+    {
+        Block& block = blocks[current_block];
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+
+        if (start + size <= block.size)
+        {
+            offset = start + size;
+            return block.memory.get() + start;
+        }
+
+        // The current block is full, move on to the next retained one
+        current_block++;
+        offset = 0;
+    }
+
+    // Every block is in use: grow the arena (oversized requests get a block of their own)
+    size_t new_block_size = std::max(block_size, size + alignment);
+    blocks.push_back({ std::make_unique<std::byte[]>(new_block_size), new_block_size });
+    current_block = int(blocks.size()) - 1;
+    offset = 0;
+
+    // Growth is rare once the arena is warmed up, so the shared counters stay off the hot path
+    size_t reserved = reserved_bytes += new_block_size;
+    size_t peak = peak_reserved;
+    while (reserved > peak && !peak_reserved.compare_exchange_weak(peak, reserved));
+
+    return allocate(size, alignment);
+}
+
+void MemoryArena::reset()
+{
+    current_block = 0;
+    offset = 0;
+}
+
+size_t MemoryArena::capacity() const
+{
+    size_t total = 0;
+
+    for (const auto& block : blocks)
+        total += block.size;
+
+    return total;
+}
+
+MemoryArena& MemoryArena::local()
+{
+    static thread_local MemoryArena arena;
+    return arena;
+}
+
+size_t MemoryArena::peak_reserved_bytes()
+{
+    return peak_reserved;
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+constexpr size_t arena_block_size = 64 * 1024;
+
+class MemoryArena // Per-thread bump allocator for transient sampling objects (PDFs). Blocks are kept and reused across resets, so a warmed up arena never calls the heap.
+{
+public:
+    MemoryArena(size_t block_size = arena_block_size);
+    ~MemoryArena();
+
+    // Destructors of arena objects are never run, so they must not own any resource
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void* allocate(size_t size, size_t alignment);
+    void reset();                           // Releases every object at once. Call when no arena object is referenced anymore.
+    size_t capacity() const;                // Bytes reserved by the arena blocks
+
+    static MemoryArena& local();            // Arena of the calling thread
+    static size_t peak_reserved_bytes();    // Highest number of bytes reserved at once by the arenas of all threads
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    size_t block_size;
+    vector<Block> blocks;
+    int current_block = 0;
+    size_t offset = 0;                      // First free byte of the current block
+};
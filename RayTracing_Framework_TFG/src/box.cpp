@@ -9,7 +9,7 @@
 #include "matrix.hpp"
 #include "utilities.hpp"
 
-Box::Box(point3 p0, point3 p1, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model) : material (material)
+Box::Box(point3 p0, point3 p1, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model, const BVHSettings& bvh_settings) : material (material)
 {
 	// Validate that p0 and p1 are not aligned in any coordinate (this would define a line or a point instead of a box)
 	if (p0.x == p1.x || p0.y == p1.y || p0.z == p1.z)
@@ -49,22 +49,22 @@ Box::Box(point3 p0, point3 p1, const shared_ptr<Material>& material, const share
 	sides_list.add(quad4);
 	sides_list.add(quad5);
 	sides_list.add(quad6);
-	sides = make_shared<bvh_node>(sides_list);
+	sides = make_shared<bvh_node>(sides_list, bvh_settings);
 	box_bvh_chrono = sides->bvh_chrono();
 
 	// Construct the bounding box of the box
 	Interval x = Interval(min.x, max.x);
 	Interval y = Interval(min.y, max.y);
 	Interval z = Interval(min.z, max.z);
-	bbox = make_shared<AABB>(x, y, z);
+	bbox = AABB(x, y, z);
 }
 
-bool Box::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool Box::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-	return sides->hit(r, ray_t, rec);
+	return sides->hit(r, ray_t, rec, sampler);
 }
 
-shared_ptr<AABB> Box::bounding_box() const
+const AABB& Box::bounding_box() const
 {
 	return bbox;
 }
@@ -3,6 +3,7 @@
 // Headers
 #include "hittable.hpp"
 #include "vec3.hpp"
+#include "bvh_split.hpp"
 
 // Forward declaration
 class Material;
@@ -14,17 +15,17 @@ struct Chrono;
 class Box : public Hittable
 {
 public:
-	Box(point3 p0, point3 p1, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model = nullptr);
+	Box(point3 p0, point3 p1, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model = nullptr, const BVHSettings& bvh_settings = BVHSettings());
 
-	bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
-	shared_ptr<AABB> bounding_box() const override;
+	bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+	const AABB& bounding_box() const override;
 	const shared_ptr<Chrono> bvh_chrono() const;
 
 private:
 	vec3 p0, p1;
 	shared_ptr<Material> material;
 	shared_ptr<bvh_node> sides;
-	shared_ptr<AABB> bbox;
+	AABB bbox;
 	shared_ptr<Chrono> box_bvh_chrono;
 };
 
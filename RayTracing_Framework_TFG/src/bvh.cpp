@@ -4,83 +4,213 @@
 #include "hittable_list.hpp"
 #include "chrono.hpp"
 #include "aabb.hpp"
+#include "ray_stats.hpp"
+#include "ray_packet.hpp"
 
-bvh_node::bvh_node(hittable_list list)
+bvh_node::bvh_node(hittable_list list, const BVHSettings& settings)
 {
     chrono = make_shared<Chrono>();
 
     chrono->start();
 
-    auto instance = bvh_node(list.objects, 0, list.objects.size());
+    auto instance = bvh_node(list.objects, 0, list.objects.size(), settings, settings.build_thread_count());
 
     chrono->end();
 
-    instance.type = BVH_NODE;
     instance.chrono = chrono;
 
     *this = instance;
 }
 
-bvh_node::bvh_node(vector<shared_ptr<Hittable>>& objects, size_t start, size_t end)
+bvh_node::bvh_node(vector<shared_ptr<Hittable>>& objects, size_t start, size_t end, const BVHSettings& settings, int threads, const MortonOrder* morton, int node_depth)
 {
+    type = BVH_NODE;
+
     // Build the bounding box of the span of source objects.
-    bbox = make_shared<AABB>(AABB::empty);
+    bbox = AABB::empty;
     for (size_t object_index = start; object_index < end; object_index++)
-        bbox = make_shared<AABB>(bbox, objects[object_index]->bounding_box());
-
-    int axis = bbox->longest_axis();
-
-    auto comparator = (axis == 0) ? box_x_compare
-        : (axis == 1) ? box_y_compare
-        : box_z_compare;
+        bbox = AABB(bbox, objects[object_index]->bounding_box());
 
     size_t object_span = end - start;
+    depth = 0;
+    nodes = 1;
 
     if (object_span == 1)
     {
-        left = right = objects[start];
-        depth = 0;
-        nodes = 1; // Same object for left and and right leaf
+        left = right = objects[start]; // Same object for left and and right leaf
+        return;
     }
-    else if (object_span == 2)
+    
+    if (object_span == 2)
     {
         left = objects[start];
         right = objects[start + 1];
-        depth = 0;
-        nodes = 1;
+        return;
+    }
+
+    auto box_of = [](const shared_ptr<Hittable>& object) -> const AABB& { return object->bounding_box(); };
+
+    MortonOrder sorted;
+    if (settings.split == LBVH_SPLIT && !morton)
+    {
+        sorted = morton_sort(objects, start, end, settings, box_of, threads);
+        morton = &sorted;
     }
+
+    size_t mid;
+    if (settings.split == SAH_SPLIT && node_depth < bvh_median_depth)
+        mid = sah_partition(objects, start, end, bbox, settings, box_of, threads);
+    else if (settings.split == LBVH_SPLIT && node_depth < bvh_median_depth)
+        mid = morton->split(start, end, settings);
     else
+        mid = median_partition(objects, start, end, bbox, box_of);
+
+    // The surface area heuristic found no split cheaper than testing every object, or the span fits in an LBVH leaf
+    if (mid == end)
     {
-        // Sort the objects based on the chosen axis
-        std::sort(std::begin(objects) + start, std::begin(objects) + end, comparator);
+        leaf.assign(objects.begin() + start, objects.begin() + end);
+        return;
+    }
 
-        // Create nodes
-        auto mid = start + object_span / 2;
-        auto left_node = make_shared<bvh_node>(objects, start, mid);
-        auto right_node = make_shared<bvh_node>(objects, mid, end);
+    // Create nodes. A single object is attached directly, so it is neither wrapped in a node nor tested twice.
+    auto make_child = [&](size_t child_start, size_t child_end, int child_threads) -> shared_ptr<Hittable>
+    {
+        if (child_end - child_start == 1)
+            return objects[child_start];
 
-        // Update depth and nodes based on the children
-        depth = std::max(left_node->depth, right_node->depth) + 1;
-        nodes = 1 + left_node->nodes + right_node->nodes;
+        return make_shared<bvh_node>(objects, child_start, child_end, settings, child_threads, morton, node_depth + 1);
+    };
 
-        // Assign nodes to hittable pointers
-        left = left_node;
-        right = right_node;
+    // Large spans build their second child on another thread, which takes half of the thread budget along
+    if (threads > 1 && object_span >= bvh_parallel_min_span)
+    {
+        int second_threads = threads / 2;
+        std::thread second_builder([&] { right = make_child(mid, end, second_threads); });
+
+        left = make_child(start, mid, threads - second_threads);
+        second_builder.join();
     }
+    else
+    {
+        left = make_child(start, mid, 1);
+        right = make_child(mid, end, 1);
+    }
+
+    // Update depth and nodes based on the children built here
+    auto count_child = [&](const shared_ptr<Hittable>& child, size_t child_span)
+    {
+        if (child_span == 1)
+            return;
+
+        const auto& child_node = static_cast<const bvh_node&>(*child);
+        depth = std::max(depth, child_node.depth + 1);
+        nodes += child_node.nodes;
+    };
+
+    count_child(left, mid - start);
+    count_child(right, end - mid);
 }
 
-bool bvh_node::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool bvh_node::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-    if (!bbox->hit(r, ray_t))
+    RayStats::local().bvh_nodes_visited++;
+
+    if (!bbox.hit(r, ray_t))
         return false;
 
-    bool hit_left = left->hit(r, ray_t, rec);
-    bool hit_right = right->hit(r, Interval(ray_t.min, hit_left ? rec->t : ray_t.max), rec);
+    return hit_children(r, ray_t, rec, sampler);
+}
+
+bool bvh_node::hit_children(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
+{
+    if (!leaf.empty())
+    {
+        bool hit_anything = false;
+
+        for (const auto& object : leaf)
+        {
+            if (object->hit(r, ray_t, rec, sampler))
+            {
+                hit_anything = true;
+                ray_t.max = rec.t;
+            }
+        }
+
+        return hit_anything;
+    }
+
+    // A node over a single object holds it on both sides. Testing it twice would give stochastic objects such as
+    // constant media a second chance to scatter.
+    bool hit_left = left->hit(r, ray_t, rec, sampler);
+    bool hit_right = right != left && right->hit(r, Interval(ray_t.min, hit_left ? rec.t : ray_t.max), rec, sampler);
 
     return hit_left || hit_right;
 }
 
-shared_ptr<AABB> bvh_node::bounding_box() const
+void bvh_node::hit_packet(RayPacket& packet, uint32_t active) const
+{
+    RayStats& stats = RayStats::local();
+    stats.packet_nodes_visited++;
+
+    // Reject the whole packet at once when interval arithmetic proves every ray misses the box
+    if (!packet.may_hit(bbox, active))
+    {
+        stats.packet_nodes_culled++;
+        return;
+    }
+
+    // Rays of the packet that enter the box
+    uint32_t inside = 0;
+    int inside_count = 0;
+
+    for (int i = 0; i < packet.size; i++)
+    {
+        if ((active >> i & 1) && bbox.hit(packet.rays[i], Interval(packet.t_min[i], packet.t_max[i])))
+        {
+            inside |= 1u << i;
+            inside_count++;
+        }
+    }
+
+    if (inside == 0)
+        return;
+
+    // Once the packet has diverged, the remaining rays are cheaper to trace on their own
+    if (inside_count * 4 <= packet.size)
+    {
+        for (int i = 0; i < packet.size; i++)
+        {
+            if (!(inside >> i & 1))
+                continue;
+
+            stats.packet_fallback_rays++;
+
+            hit_record& rec = packet.records[i];
+
+            if (hit_children(packet.rays[i], Interval(packet.t_min[i], packet.t_max[i]), rec, *packet.samplers[i]))
+            {
+                packet.hits |= 1u << i;
+                packet.t_max[i] = rec.t;
+            }
+        }
+
+        return;
+    }
+
+    if (!leaf.empty())
+    {
+        for (const auto& object : leaf)
+            object->hit_packet(packet, inside);
+
+        return;
+    }
+
+    left->hit_packet(packet, inside);
+    if (right != left)
+        right->hit_packet(packet, inside);
+}
+
+const AABB& bvh_node::bounding_box() const
 {
     return bbox;
 }
@@ -90,24 +220,28 @@ const shared_ptr<Chrono> bvh_node::bvh_chrono() const
     return chrono;
 }
 
-bool bvh_node::box_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b, int axis_index)
+double bvh_node::sah_cost(const BVHSettings& settings) const
 {
-    auto a_axis_interval = a->bounding_box()->axis_interval(axis_index);
-    auto b_axis_interval = b->bounding_box()->axis_interval(axis_index);
-    return a_axis_interval->min < b_axis_interval->min;
-}
+    // Every object of a leaf is tested once the node box is entered
+    if (!leaf.empty())
+        return settings.traversal_cost + settings.intersection_cost * leaf.size();
+
+    // Child nodes are entered with the probability that a ray crossing this box also crosses theirs, while
+    // objects held directly by the node are tested unconditionally
+    double area = bbox.surface_area();
+    auto child_cost = [&](const Hittable& child)
+    {
+        if (child.get_type() != BVH_NODE)
+            return settings.intersection_cost;
 
-bool bvh_node::box_x_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b)
-{
-    return box_compare(a, b, 0);
-}
+        const auto& child_node = static_cast<const bvh_node&>(child);
+        double probability = area > 0 ? child_node.bbox.surface_area() / area : 1.0;
+        return probability * child_node.sah_cost(settings);
+    };
 
-bool bvh_node::box_y_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b)
-{
-    return box_compare(a, b, 1);
-}
+    double cost = settings.traversal_cost + child_cost(*left);
+    if (right != left)
+        cost += child_cost(*right);
 
-bool bvh_node::box_z_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b)
-{
-    return box_compare(a, b, 2);
+    return cost;
 }
@@ -3,6 +3,7 @@
 // Headers
 #include "core.hpp"
 #include "hittable.hpp"
+#include "bvh_split.hpp"
 
 // Forward declarations
 class hittable_list;
@@ -17,24 +18,30 @@ public:
 
     // Creates an implicit copy of the hittable list, which we will modify. 
     // The lifetime of the copied list only extends until this constructor exits.
-    bvh_node(hittable_list list);  
+    bvh_node(hittable_list list, const BVHSettings& settings = BVHSettings());  
 
-    bvh_node(vector<shared_ptr<Hittable>>& objects, size_t start, size_t end);
+    // Builds the subtree over objects[start, end) with up to threads threads, handing half of them to the second child of large spans.
+    // The LBVH split sorts the span along a Morton curve first, unless morton already holds the order its subtrees share.
+    // Nodes at node_depth bvh_median_depth and deeper are split at the median, so skewed scenes still fit the flattened traversal stack.
+    bvh_node(vector<shared_ptr<Hittable>>& objects, size_t start, size_t end, const BVHSettings& settings = BVHSettings(), int threads = 1,
+        const MortonOrder* morton = nullptr, int node_depth = 0);
 
-    bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
-    shared_ptr<AABB> bounding_box() const override;
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+    const AABB& bounding_box() const override;
+    void hit_packet(RayPacket& packet, uint32_t active) const override;
     const shared_ptr<Chrono> bvh_chrono() const;
+    double sah_cost(const BVHSettings& settings) const;    // Expected traversal and intersection cost of a ray entering the node box
 
 private:
+    friend class LinearBVH;     // Flattens the finished tree
+
     shared_ptr<Hittable> left;
     shared_ptr<Hittable> right;
-    shared_ptr<AABB> bbox;
+    vector<shared_ptr<Hittable>> leaf;  // Objects of a leaf with more than two of them, in which case left and right are null
+    AABB bbox;
     shared_ptr<Chrono> chrono;
 
-    static bool box_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b, int axis_index);
-    static bool box_x_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b);
-    static bool box_y_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b);
-    static bool box_z_compare(const shared_ptr<Hittable>& a, const shared_ptr<Hittable>& b);
+    bool hit_children(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const;
 };
 
 
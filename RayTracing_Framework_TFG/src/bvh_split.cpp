@@ -0,0 +1,113 @@
+﻿// Headers
+#include "core.hpp"
+#include "bvh_split.hpp"
+#include "cpu_features.hpp"
+#include "scheduler.hpp"
+
+int BVHSettings::leaf_size() const
+{
+    return std::clamp(max_leaf_size, 1, bvh_max_leaf_size);
+}
+
+int BVHSettings::node_width() const
+{
+    if (width != 0)
+        return width;
+
+    return (simd && CPUFeatures::host().avx2) ? 8 : 4;
+}
+
+int BVHSettings::build_thread_count() const
+{
+    return TileScheduler::resolve_thread_count(build_threads);
+}
+
+int BVHSettings::morton_code_bits() const
+{
+    return (morton_bits > 30) ? 63 : 30;
+}
+
+string BVHSettings::description() const
+{
+    if (split == MEDIAN_SPLIT)
+        return "Median";
+
+    if (split == LBVH_SPLIT)
+    {
+        int cluster_bits = std::clamp(hlbvh_cluster_bits, 0, morton_code_bits());
+        string clusters = cluster_bits ? ", SAH over " + std::to_string(cluster_bits) + "-bit clusters" : "";
+
+        return string(cluster_bits ? "HLBVH" : "LBVH") + " (" + std::to_string(morton_code_bits()) + "-bit Morton codes" + clusters
+            + ", max leaf size " + std::to_string(leaf_size()) + ")";
+    }
+
+    return "SAH (" + std::to_string(std::clamp(sah_bins, 2, sah_max_bins)) + " bins, max leaf size " + std::to_string(leaf_size()) + ")";
+}
+
+size_t MortonOrder::split(size_t start, size_t end, const BVHSettings& settings) const
+{
+    size_t count = end - start;
+
+    if (count <= size_t(settings.leaf_size()))
+        return end;
+
+    uint64_t first_code = codes[start - first];
+    uint64_t last_code = codes[end - 1 - first];
+
+    // The span covers several clusters, which always start and end it: sweep the surface area heuristic over their boundaries
+    if ((first_code >> cluster_shift) != (last_code >> cluster_shift))
+    {
+        size_t first_cluster = size_t(std::lower_bound(cluster_starts.begin(), cluster_starts.end(), start) - cluster_starts.begin());
+        size_t end_cluster = size_t(std::lower_bound(cluster_starts.begin(), cluster_starts.end(), end) - cluster_starts.begin());
+
+        // Sweep from the right to gather the cost right of every boundary
+        vector<double> right_cost(end_cluster - first_cluster);
+        AABB right_bbox = AABB::empty;
+
+        for (size_t c = end_cluster - 1; c > first_cluster; c--)
+        {
+            right_bbox = AABB(right_bbox, cluster_bboxes[c]);
+            right_cost[c - first_cluster] = right_bbox.surface_area() * double(end - cluster_starts[c]);
+        }
+
+        // Sweep from the left and keep the cheapest boundary
+        AABB left_bbox = AABB::empty;
+        double best_cost = infinity;
+        size_t best_split = cluster_starts[first_cluster + 1];
+
+        for (size_t c = first_cluster + 1; c < end_cluster; c++)
+        {
+            left_bbox = AABB(left_bbox, cluster_bboxes[c - 1]);
+            double cost = left_bbox.surface_area() * double(cluster_starts[c] - start) + right_cost[c - first_cluster];
+
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_split = cluster_starts[c];
+            }
+        }
+
+        return best_split;
+    }
+
+    // Every code coincides, so no bit separates them: split the span in half
+    if (first_code == last_code)
+        return start + count / 2;
+
+    // The codes are sorted, so the items with the highest differing bit clear all precede the ones with it set
+    int bit = 63 - std::countl_zero(first_code ^ last_code);
+    size_t low = start;     // Has the bit clear
+    size_t high = end - 1;  // Has the bit set
+
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if ((codes[middle - first] >> bit) & 1)
+            high = middle;
+        else
+            low = middle;
+    }
+
+    return high;
+}
@@ -0,0 +1,342 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "aabb.hpp"
+#include "utilities.hpp"
+
+// Macros
+constexpr int sah_max_bins = 64;        // Upper bound of BVHSettings::sah_bins
+constexpr int bvh_max_leaf_size = 255;  // Upper bound of BVHSettings::max_leaf_size
+constexpr int bvh_median_depth = 32;    // Nodes this deep are split at the median instead of by the SAH or the LBVH, which keeps the depth below linear_bvh_stack_size
+constexpr size_t bvh_parallel_min_span = 16384;    // Smaller spans are binned and built on one thread, as starting another one costs more
+
+enum BVH_SPLIT
+{
+    MEDIAN_SPLIT,   // Halves the span sorted along the longest axis of its bounds
+    SAH_SPLIT,      // Binned surface area heuristic over the primitive centroids
+    LBVH_SPLIT      // Radix sorts the centroids along a Morton curve once and splits every span where its highest differing code bit flips
+};
+
+struct BVHSettings // Build parameters shared by the scene, box and mesh BVH builders
+{
+    BVH_SPLIT split = SAH_SPLIT;
+    int sah_bins = 16;                  // Centroid bins evaluated per axis, clamped to [2, sah_max_bins]
+    double traversal_cost = 0.125;      // Cost of visiting a node, relative to intersection_cost
+    double intersection_cost = 1.0;     // Cost of testing one primitive
+    int max_leaf_size = 4;              // Spans above this size are always split. The median split keeps its leaves of one or two primitives.
+    bool flatten = true;                // Flattens the scene BVH into 32-byte nodes traversed near child first, instead of tracing the pointer tree
+    int width = 0;                      // Children per node of the flattened scene and mesh BVHs: 2 keeps the binary nodes, 4 or 8 collapse them into wide nodes
+    bool simd = true;                   // Tests the children of a wide node with SSE or AVX2 when the CPU supports them, instead of one after the other
+    int build_threads = 0;              // Threads building each scene and mesh BVH, 0 uses every hardware thread
+    int morton_bits = 30;               // Bits of the LBVH Morton codes: 30 (10 per axis) or 63 (21 per axis)
+    int hlbvh_cluster_bits = 0;         // Top Morton code bits grouping the LBVH primitives into clusters whose upper tree is split by the SAH (HLBVH), 0 keeps a plain LBVH
+    bool compare_splits = false;        // Also builds the scene BVH with the other split method, so the log can compare the SAH costs of both trees
+
+    int leaf_size() const;              // max_leaf_size clamped to [1, bvh_max_leaf_size]
+    int node_width() const;             // width, or 8 when it is 0 and the AVX2 node test is available and 4 otherwise
+    int build_thread_count() const;     // build_threads, or the hardware threads when it is not positive
+    int morton_code_bits() const;       // morton_bits rounded to 30 or 63
+    string description() const;
+};
+
+struct MortonOrder // Morton codes of a span of BVH items sorted along with them, and the clusters of items sharing their top code bits
+{
+    size_t first = 0;                   // First item of the sorted span
+    int code_bits = 30;
+    int cluster_shift = 30;             // A code shifted right by this many bits gives the cluster of its item
+    vector<uint64_t> codes;             // Code of every item of the span, in sorted order
+    vector<size_t> cluster_starts;      // First item of every cluster followed by the end of the span, empty without clusters
+    vector<AABB> cluster_bboxes;
+
+    // Returns the split index of the sorted items[start, end), or end when they fit in a leaf. Spans over several clusters
+    // are split by the surface area heuristic at a cluster boundary, the others where their highest differing code bit flips.
+    size_t split(size_t start, size_t end, const BVHSettings& settings) const;
+};
+
+// Splits [start, end) into one contiguous chunk per thread and runs body(chunk_start, chunk_end, chunk) on all of them at
+// once, the first chunk on the calling thread. Spans below bvh_parallel_min_span are handed to body as a single chunk.
+template <typename Body>
+void parallel_chunks(size_t start, size_t end, int threads, Body&& body)
+{
+    size_t count = end - start;
+
+    if (threads <= 1 || count < bvh_parallel_min_span)
+    {
+        body(start, end, 0);
+        return;
+    }
+
+    vector<std::thread> workers;
+    for (int chunk = 1; chunk < threads; chunk++)
+        workers.emplace_back([&, chunk] { body(start + count * chunk / threads, start + count * (chunk + 1) / threads, chunk); });
+
+    body(start, start + count / threads, 0);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// Partitions items[start, end) around the median of the bounding box minimums on the longest axis of bounds and returns the split index.
+template <typename T, typename BoxOf>
+size_t median_partition(vector<T>& items, size_t start, size_t end, const AABB& bounds, BoxOf&& box_of)
+{
+    int axis = bounds.longest_axis();
+    size_t mid = start + (end - start) / 2;
+
+    // Only the partition around the median matters, so a full sort is not needed
+    std::nth_element(items.begin() + start, items.begin() + mid, items.begin() + end, [&](const T& a, const T& b)
+    {
+        return box_of(a).axis_interval(axis).min < box_of(b).axis_interval(axis).min;
+    });
+
+    return mid;
+}
+
+// Bins the centroids of items[start, end) on every axis and evaluates the surface area heuristic at each bin boundary.
+// Partitions the items at the cheapest boundary and returns the split index, or returns end when a leaf is cheaper than
+// any split and the span fits in a leaf. Large spans are binned by up to threads threads, each over a chunk of the span.
+template <typename T, typename BoxOf>
+size_t sah_partition(vector<T>& items, size_t start, size_t end, const AABB& bounds, const BVHSettings& settings, BoxOf&& box_of, int threads = 1)
+{
+    struct Bin
+    {
+        AABB bbox = AABB::empty;
+        size_t count = 0;
+    };
+
+    struct CentroidBounds
+    {
+        real min[3] = { real(infinity), real(infinity), real(infinity) };
+        real max[3] = { real(-infinity), real(-infinity), real(-infinity) };
+    };
+
+    using AxisBins = std::array<std::array<Bin, sah_max_bins>, 3>;
+
+    size_t count = end - start;
+    int bins = std::clamp(settings.sah_bins, 2, sah_max_bins);
+    threads = std::max(threads, 1);
+
+    // Bounds of the centroids, which the bins subdivide. The first chunk fills centroids, the others their own bounds merged into it.
+    CentroidBounds centroids;
+    vector<CentroidBounds> chunk_centroids(threads - 1);
+
+    parallel_chunks(start, end, threads, [&](size_t chunk_start, size_t chunk_end, int chunk)
+    {
+        CentroidBounds& local = (chunk == 0) ? centroids : chunk_centroids[chunk - 1];
+
+        for (size_t i = chunk_start; i < chunk_end; i++)
+        {
+            point3 centroid = box_of(items[i]).centroid();
+            for (int axis = 0; axis < 3; axis++)
+            {
+                local.min[axis] = std::min(local.min[axis], centroid[axis]);
+                local.max[axis] = std::max(local.max[axis], centroid[axis]);
+            }
+        }
+    });
+
+    for (const auto& local : chunk_centroids)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            centroids.min[axis] = std::min(centroids.min[axis], local.min[axis]);
+            centroids.max[axis] = std::max(centroids.max[axis], local.max[axis]);
+        }
+    }
+
+    const real* centroid_min = centroids.min;
+    const real* centroid_max = centroids.max;
+
+    auto bin_of = [&](real centroid, int axis)
+    {
+        real extent = centroid_max[axis] - centroid_min[axis];
+        int bin = int(bins * ((centroid - centroid_min[axis]) / extent));
+        return std::min(bin, bins - 1);
+    };
+
+    // Bin every item on all three axes in one pass. The first chunk fills bin, the others their own bins merged into it.
+    AxisBins bin;
+    vector<AxisBins> chunk_bins(threads - 1);
+
+    parallel_chunks(start, end, threads, [&](size_t chunk_start, size_t chunk_end, int chunk)
+    {
+        AxisBins& local = (chunk == 0) ? bin : chunk_bins[chunk - 1];
+
+        for (size_t i = chunk_start; i < chunk_end; i++)
+        {
+            const AABB& box = box_of(items[i]);
+            point3 centroid = box.centroid();
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (!(centroid_max[axis] > centroid_min[axis]))
+                    continue;
+
+                Bin& target = local[axis][bin_of(centroid[axis], axis)];
+                target.bbox = AABB(target.bbox, box);
+                target.count++;
+            }
+        }
+    });
+
+    for (const auto& local : chunk_bins)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            for (int b = 0; b < bins; b++)
+            {
+                bin[axis][b].bbox = AABB(bin[axis][b].bbox, local[axis][b].bbox);
+                bin[axis][b].count += local[axis][b].count;
+            }
+        }
+    }
+
+    double parent_area = bounds.surface_area();
+    double best_cost = infinity;
+    int best_axis = -1;
+    int best_split = 0;     // Bins [0, best_split] go to the left child
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (!(centroid_max[axis] > centroid_min[axis]))
+            continue;
+
+        const auto& axis_bins = bin[axis];
+
+        // Sweep from the right to gather the area and count right of every boundary
+        std::array<double, sah_max_bins> right_area;
+        std::array<size_t, sah_max_bins> right_count;
+        AABB right_bbox = AABB::empty;
+        size_t right_total = 0;
+
+        for (int b = bins - 1; b > 0; b--)
+        {
+            right_bbox = AABB(right_bbox, axis_bins[b].bbox);
+            right_total += axis_bins[b].count;
+            right_area[b - 1] = right_total ? right_bbox.surface_area() : 0.0;
+            right_count[b - 1] = right_total;
+        }
+
+        // Sweep from the left and evaluate the cost of every boundary
+        AABB left_bbox = AABB::empty;
+        size_t left_total = 0;
+
+        for (int b = 0; b < bins - 1; b++)
+        {
+            left_bbox = AABB(left_bbox, axis_bins[b].bbox);
+            left_total += axis_bins[b].count;
+
+            if (left_total == 0 || right_count[b] == 0)
+                continue;
+
+            double cost = settings.traversal_cost + settings.intersection_cost
+                * (left_bbox.surface_area() * left_total + right_area[b] * right_count[b]) / parent_area;
+
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b;
+            }
+        }
+    }
+
+    bool fits_leaf = count <= size_t(settings.leaf_size());
+
+    if (fits_leaf && (best_axis < 0 || settings.intersection_cost * count <= best_cost))
+        return end;
+
+    // Every centroid coincides, so no boundary separates them: split the span in half
+    if (best_axis < 0)
+        return start + count / 2;
+
+    auto middle = std::partition(items.begin() + start, items.begin() + end, [&](const T& item)
+    {
+        return bin_of(box_of(item).centroid()[best_axis], best_axis) <= best_split;
+    });
+
+    return size_t(middle - items.begin());
+}
+
+// Radix sorts items[start, end) by the Morton codes of their centroids, quantized within the centroid bounds, and groups
+// them into the clusters of settings.hlbvh_cluster_bits. Large spans are encoded by up to threads threads.
+template <typename T, typename BoxOf>
+MortonOrder morton_sort(vector<T>& items, size_t start, size_t end, const BVHSettings& settings, BoxOf&& box_of, int threads = 1)
+{
+    MortonOrder morton;
+    morton.first = start;
+    morton.code_bits = settings.morton_code_bits();
+    morton.cluster_shift = morton.code_bits - std::clamp(settings.hlbvh_cluster_bits, 0, morton.code_bits);
+
+    size_t count = end - start;
+    if (count == 0)
+        return morton;
+
+    // Bounds of the centroids, which the codes quantize
+    real centroid_min[3] = { real(infinity), real(infinity), real(infinity) };
+    real centroid_max[3] = { real(-infinity), real(-infinity), real(-infinity) };
+
+    for (size_t i = start; i < end; i++)
+    {
+        point3 centroid = box_of(items[i]).centroid();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            centroid_min[axis] = std::min(centroid_min[axis], centroid[axis]);
+            centroid_max[axis] = std::max(centroid_max[axis], centroid[axis]);
+        }
+    }
+
+    double scale[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        double extent = double(centroid_max[axis]) - double(centroid_min[axis]);
+        scale[axis] = extent > 0.0 ? 1.0 / extent : 0.0;
+    }
+
+    vector<uint64_t> keys(count);
+    vector<int> order(count);
+
+    parallel_chunks(start, end, threads, [&](size_t chunk_start, size_t chunk_end, int)
+    {
+        for (size_t i = chunk_start; i < chunk_end; i++)
+        {
+            point3 centroid = box_of(items[i]).centroid();
+            double x = (double(centroid[0]) - centroid_min[0]) * scale[0];
+            double y = (double(centroid[1]) - centroid_min[1]) * scale[1];
+            double z = (double(centroid[2]) - centroid_min[2]) * scale[2];
+
+            keys[i - start] = (morton.code_bits == 63) ? morton_code_63(x, y, z) : morton_code(x, y, z);
+            order[i - start] = int(i - start);
+        }
+    });
+
+    radix_sort(keys, order, morton.code_bits);
+
+    vector<T> sorted;
+    sorted.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        sorted.push_back(std::move(items[start + order[i]]));
+
+    std::move(sorted.begin(), sorted.end(), items.begin() + start);
+    morton.codes = std::move(keys);
+
+    if (morton.cluster_shift == morton.code_bits)
+        return morton;
+
+    // Runs of equal top code bits form the clusters
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i == 0 || (morton.codes[i] >> morton.cluster_shift) != (morton.codes[i - 1] >> morton.cluster_shift))
+        {
+            morton.cluster_starts.push_back(start + i);
+            morton.cluster_bboxes.push_back(AABB::empty);
+        }
+
+        morton.cluster_bboxes.back() = AABB(morton.cluster_bboxes.back(), box_of(items[start + i]));
+    }
+
+    morton.cluster_starts.push_back(end);
+
+    return morton;
+}
@@ -12,6 +12,15 @@
 #include "material.hpp"
 #include "pdf.hpp"
 #include "triangle.hpp"
+#include "scheduler.hpp"
+#include "system_info.hpp"
+#include "sampler.hpp"
+#include "framebuffer.hpp"
+#include "ray_queue.hpp"
+#include "ray_packet.hpp"
+#include "aabb.hpp"
+#include "checkpoint.hpp"
+#include "arena.hpp"
 
 Camera::Camera() 
 {
@@ -53,100 +62,660 @@ void Camera::initialize(const Scene& scene, const ImageWriter& image)
     pixel_sample_sqrt = int(sqrt(scene.samples_per_pixel));
     pixel_sample_sqrt_inv = 1.0 / pixel_sample_sqrt;
 
+    // Pick a stride near the golden ratio of the strata count so every pass spreads its samples over the whole pixel
+    pixel_strata = pixel_sample_sqrt * pixel_sample_sqrt;
+    stratum_stride = std::max(1, int(pixel_strata * 0.618));
+    while (std::gcd(stratum_stride, pixel_strata) != 1)
+        stratum_stride++;
+
     // Log info
     Logger::info("CAMERA", "Camera settings succesfully initialized.");
 }
 
 void Camera::render(Scene& scene, ImageWriter& image)
+{
+    // Start from an empty accumulation buffer or from the checkpoint of an earlier run
+    image.framebuffer->clear();
+    passes_resumed = 0;
+    seconds_resumed = 0.0;
+
+    checkpoint_header checkpoint;
+    if (resume && !checkpoint_path.empty())
+    {
+        if (Checkpoint::load(checkpoint_path, scene.config_hash(*this, image), *image.framebuffer, checkpoint))
+        {
+            passes_resumed = checkpoint.passes_rendered;
+            seconds_resumed = checkpoint.render_seconds;
+            Logger::info("CAMERA", std::format("Resuming from checkpoint after {} passes ({} to {} samples per pixel).", passes_resumed, image.framebuffer->min_samples(), image.framebuffer->max_samples()));
+        }
+        else
+        {
+            image.framebuffer->clear();
+            Logger::warn("CAMERA", "No matching checkpoint found at " + checkpoint_path + ". Rendering from scratch.");
+        }
+    }
+
+    // Render the whole frame
+    render(scene, image, Tile{ 0, 0, image.height, 0, image.width });
+
+    // Last checkpoint, so a render stopped by its time budget can be continued later
+    if (!checkpoint_path.empty())
+        save_checkpoint(scene, image);
+
+    // Convert the accumulated samples to the output image
+    image.resolve();
+}
+
+void Camera::render(Scene& scene, ImageWriter& image, const Tile& region)
 {
     // Log info
     Logger::info("CAMERA", "Rendering started.");
 
-    // Calculate primary rays to cast
-    primary_rays = image.height * image.width * pixel_sample_sqrt * pixel_sample_sqrt;
+    // Split the region into tiles and spread them over the render threads
+    TileScheduler scheduler(region, tile_size, threads);
+    SystemInfo::cpu_threads = scheduler.num_threads();
+
+    // Give every render thread its own counter block
+    thread_stats.assign(scheduler.num_threads(), RayStats());
+
+    // Log info
+    Logger::info("CAMERA", std::format("Rendering {} tiles with {} threads.", scheduler.num_tiles(), scheduler.num_threads()));
+
+    // Single pass renders take every sample at once. Progressive, adaptive and checkpointed renders split them into passes.
+    int target_samples = std::max(1, scene.samples_per_pixel);
+    int pass_samples = renders_in_passes() ? std::clamp(samples_per_pass, 1, target_samples) : target_samples;
+    double budget = progressive ? time_budget : 0.0;
+    double last_preview = 0.0;
+    double last_checkpoint = 0.0;
+
+    // Reset the pass counters
+    passes_rendered = 0;
+    budget_exhausted = false;
 
     // Start render chrono
     render_chrono->start();
 
-    for (int pixel_row = 0; pixel_row < image.height; pixel_row++)
+    // Render passes until no pixel needs more samples
+    std::atomic<int> pixels_pending = (region.row_end - region.row_start) * (region.column_end - region.column_start);
+    while (pixels_pending > 0)
     {
-        // Progress info
-        std::clog << "\rScanlines remaining: " << (image.height - pixel_row) << ' ' << std::flush;
+        bool first_pass = passes_rendered == 0;
+        pixels_pending = 0;
+
+        // Render tiles
+        scheduler.run([&](const Tile& tile, int worker_index)
+        {
+            // Once the budget runs out the remaining tiles of the pass are skipped. Their pixels keep the samples of earlier passes.
+            if (!first_pass && budget > 0.0 && render_chrono->elapsed_seconds() >= budget)
+            {
+                pixels_pending += (tile.row_end - tile.row_start) * (tile.column_end - tile.column_start);
+                return;
+            }
+
+            RayStats::bind(&thread_stats[worker_index]);
+            if (integrator == WAVEFRONT)
+                pixels_pending += render_tile_wavefront(tile, pass_samples, target_samples, scene, image);
+            else if (packet_size > 1 && scene.bounce_max_depth > 0)
+                pixels_pending += render_tile_packets(tile, pass_samples, target_samples, scene, image);
+            else
+                pixels_pending += render_tile(tile, pass_samples, target_samples, scene, image);
+        });
+
+        passes_rendered++;
+
+        if (pixels_pending > 0 && budget > 0.0 && render_chrono->elapsed_seconds() >= budget)
+        {
+            budget_exhausted = true;
+            break;
+        }
+
+        // Intermediate preview
+        if (progressive && preview_interval > 0.0 && pixels_pending > 0 && render_chrono->elapsed_seconds() - last_preview >= preview_interval)
+        {
+            image.resolve();
+            image.save_preview();
+            last_preview = render_chrono->elapsed_seconds();
+        }
+
+        // Periodic checkpoint. Passes are the only points where every pixel holds whole pass sums.
+        if (!checkpoint_path.empty() && pixels_pending > 0 && render_chrono->elapsed_seconds() - last_checkpoint >= checkpoint_interval)
+        {
+            save_checkpoint(scene, image);
+            last_checkpoint = render_chrono->elapsed_seconds();
+        }
+    }
+
+    // Progress info end line
+    std::cout << std::endl;
+
+    // End render chrono
+    render_chrono->end();
+
+    // Log info
+    if (budget_exhausted)
+        Logger::warn("CAMERA", std::format("Time budget exhausted after {} passes ({} to {} samples per pixel).", passes_rendered, image.framebuffer->min_samples(), image.framebuffer->max_samples()));
+
+    // Merge the per-thread counters
+    ray_stats.reset();
+    for (const auto& stats : thread_stats)
+        ray_stats += stats;
+
+    // Benchmark rays
+    auto render_seconds = render_chrono->elapsed_seconds();
+    mrays_per_second = render_seconds > 0.0 ? ray_stats.total_rays() / render_seconds / 1e6 : 0.0;
+}
+
+int Camera::render_tile(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image)
+{
+    // Random number context of this tile. Every pixel sample reseeds it, so the tile-to-thread mapping never changes the image.
+    Sampler sampler;
+
+    // Ray counters and sampling arena of the rendering thread
+    RayStats& stats = RayStats::local();
+    MemoryArena& arena = MemoryArena::local();
+
+    // Float accumulation buffer of the image
+    Framebuffer& framebuffer = *image.framebuffer;
+
+    // Pixels that still need samples after this pass
+    int pixels_pending = 0;
 
-        for (int pixel_column = 0; pixel_column < image.width; pixel_column++)
+    for (int pixel_row = tile.row_start; pixel_row < tile.row_end; pixel_row++)
+    {
+        for (int pixel_column = tile.column_start; pixel_column < tile.column_end; pixel_column++)
         {
-            // Final pixel color
+            // Pixel position in the image buffers (row-major order)
+            int pixel_index = image.width * pixel_row + pixel_column;
+
+            // Skip converged pixels
+            if (!pixel_needs_samples(framebuffer, pixel_index, max_samples))
+                continue;
+
+            // Samples of this pass continue the pixel sample sequence
+            int first_sample = framebuffer.samples(pixel_index);
+            int last_sample = std::min(first_sample + pass_samples, max_samples);
+
+            // Sums of the pass samples
             color pixel_color(0, 0, 0);
+            double luminance_sum = 0.0;
+            double luminance_square_sum = 0.0;
 
             // Sample points with stratified sampling for antialisasing
-            for (int sample_row = 0; sample_row < pixel_sample_sqrt; sample_row++)
+            for (int sample_index = first_sample; sample_index < last_sample; sample_index++)
             {
-                for (int sample_column = 0; sample_column < pixel_sample_sqrt; sample_column++)
+                // Select the random stream of this pixel sample
+                sampler.start_pixel_sample(pixel_index, sample_index);
+
+                // Get ray sample around pixel location
+                auto sample_ray = get_ray_sample(pixel_row, pixel_column, sample_index, sampler);
+                stats.count_ray(CAMERA_RAY, 0);
+
+                // Get pixel color of the sample point that ray sample points to
+                color sample_color = ray_color(sample_ray, scene.bounce_max_depth, scene, sampler);
+                pixel_color += sample_color;
+
+                // The sample's PDFs are no longer referenced
+                arena.reset();
+
+                // Error estimate moments
+                double luminance = display_luminance(sample_color);
+                luminance_sum += luminance;
+                luminance_square_sum += luminance * luminance;
+            }
+
+            // Accumulate the pass samples. Tiles never overlap, so no locking is needed.
+            framebuffer.add_samples(pixel_index, pixel_color, luminance_sum, luminance_square_sum, last_sample - first_sample);
+
+            if (pixel_needs_samples(framebuffer, pixel_index, max_samples))
+                pixels_pending++;
+        }
+    }
+
+    return pixels_pending;
+}
+
+int Camera::render_tile_packets(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image)
+{
+    // Packet footprint in pixels
+    int packet_pixels = packet_size >= 16 ? 16 : packet_size >= 8 ? 8 : 4;
+    int packet_width = packet_pixels >= 8 ? 4 : 2;
+    int packet_height = packet_pixels / packet_width;
+
+    // Random number contexts of the packet rays, one per pixel of the footprint
+    array<Sampler, ray_packet_max_size> samplers;
+    RayPacket packet;
+
+    // Ray counters and sampling arena of the rendering thread
+    RayStats& stats = RayStats::local();
+    MemoryArena& arena = MemoryArena::local();
+
+    // Float accumulation buffer of the image
+    Framebuffer& framebuffer = *image.framebuffer;
+
+    // Pixels that still need samples after this pass
+    int pixels_pending = 0;
+
+    for (int block_row = tile.row_start; block_row < tile.row_end; block_row += packet_height)
+    {
+        for (int block_column = tile.column_start; block_column < tile.column_end; block_column += packet_width)
+        {
+            // Block pixels that need samples in this pass
+            int block_size = 0;
+            array<int, ray_packet_max_size> pixel_indices, first_samples, sample_counts;
+            array<color, ray_packet_max_size> pixel_colors;
+            array<double, ray_packet_max_size> luminance_sums, luminance_square_sums;
+            int block_samples = 0;
+
+            for (int pixel_row = block_row; pixel_row < std::min(block_row + packet_height, tile.row_end); pixel_row++)
+            {
+                for (int pixel_column = block_column; pixel_column < std::min(block_column + packet_width, tile.column_end); pixel_column++)
                 {
-                    // Get ray sample around pixel location
-                    auto sample_ray = get_ray_sample(pixel_row, pixel_column, sample_row, sample_column);
+                    int pixel_index = image.width * pixel_row + pixel_column;
+
+                    if (!pixel_needs_samples(framebuffer, pixel_index, max_samples))
+                        continue;
+
+                    int first_sample = framebuffer.samples(pixel_index);
+                    pixel_indices[block_size] = pixel_index;
+                    first_samples[block_size] = first_sample;
+                    sample_counts[block_size] = std::min(first_sample + pass_samples, max_samples) - first_sample;
+                    pixel_colors[block_size] = color(0, 0, 0);
+                    luminance_sums[block_size] = luminance_square_sums[block_size] = 0.0;
+                    block_samples = std::max(block_samples, sample_counts[block_size]);
+                    block_size++;
+                }
+            }
 
-                    // Get pixel color of the sample point that ray sample points to
-                    pixel_color += ray_color(sample_ray, scene.bounce_max_depth, scene);
+            // One packet per pass sample: the k-th sample of every block pixel
+            array<int, ray_packet_max_size> packet_slots;
+
+            for (int k = 0; k < block_samples; k++)
+            {
+                packet.clear();
+
+                for (int slot = 0; slot < block_size; slot++)
+                {
+                    if (k >= sample_counts[slot])
+                        continue;
+
+                    int pixel_index = pixel_indices[slot];
+                    Sampler& sampler = samplers[slot];
+
+                    // Select the random stream of this pixel sample and get its camera ray
+                    sampler.start_pixel_sample(pixel_index, first_samples[slot] + k);
+                    auto sample_ray = get_ray_sample(pixel_index / image.width, pixel_index % image.width, first_samples[slot] + k, sampler);
+                    stats.count_ray(CAMERA_RAY, 0);
+
+                    // The first intersection draws from the first bounce stream, as in ray_color
+                    sampler.start_bounce(1);
+
+                    packet_slots[packet.size] = slot;
+                    packet.add(sample_ray, &sampler, hit_epsilon(sample_ray, scene.min_hit_distance), infinity);
+                }
+
+                // Trace the packet and shade each ray on its own
+                packet.compute_bounds();
+                scene.intersect_packet(packet);
+
+                for (int i = 0; i < packet.size; i++)
+                {
+                    int slot = packet_slots[i];
+                    color sample_color = shade_hit(packet.rays[i], (packet.hits >> i & 1) ? &packet.records[i] : nullptr, scene.bounce_max_depth, scene, samplers[slot]);
+                    double luminance = display_luminance(sample_color);
+
+                    pixel_colors[slot] += sample_color;
+                    luminance_sums[slot] += luminance;
+                    luminance_square_sums[slot] += luminance * luminance;
+
+                    arena.reset();
                 }
             }
 
-            // Avarage samples
-            pixel_color /= scene.samples_per_pixel;
+            // Accumulate the pass samples. Tiles never overlap, so no locking is needed.
+            for (int slot = 0; slot < block_size; slot++)
+            {
+                framebuffer.add_samples(pixel_indices[slot], pixel_colors[slot], luminance_sums[slot], luminance_square_sums[slot], sample_counts[slot]);
 
-            // Compute color
-            tuple<int, int, int> RGB_color = compute_color(pixel_color);
+                if (pixel_needs_samples(framebuffer, pixel_indices[slot], max_samples))
+                    pixels_pending++;
+            }
+        }
+    }
 
-            // Determine pixel position in image buffer
-            int pixel_position = 3 * (image.width * pixel_row + pixel_column);
+    return pixels_pending;
+}
 
-            // Save pixel color into image buffer (row-major order)
-            image.write_pixel(pixel_position, RGB_color);
+int Camera::render_tile_wavefront(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image)
+{
+    // Random number context of the camera rays. Every pixel sample reseeds it and each queued path carries a copy.
+    Sampler sampler;
+
+    // Ray counters of the rendering thread
+    RayStats& stats = RayStats::local();
+
+    // Float accumulation buffer of the image
+    Framebuffer& framebuffer = *image.framebuffer;
+
+    // Tile pixels that need samples in this pass, with the sample range each one takes
+    vector<int> pixel_indices, first_samples, last_samples;
+
+    for (int pixel_row = tile.row_start; pixel_row < tile.row_end; pixel_row++)
+    {
+        for (int pixel_column = tile.column_start; pixel_column < tile.column_end; pixel_column++)
+        {
+            int pixel_index = image.width * pixel_row + pixel_column;
+
+            if (!pixel_needs_samples(framebuffer, pixel_index, max_samples))
+                continue;
+
+            int first_sample = framebuffer.samples(pixel_index);
+            pixel_indices.push_back(pixel_index);
+            first_samples.push_back(first_sample);
+            last_samples.push_back(std::min(first_sample + pass_samples, max_samples));
         }
     }
 
-    // Progress info end line
-    std::cout << std::endl;
+    // Sums of the pass samples per listed pixel
+    int pixel_count = int(pixel_indices.size());
+    vector<color> pixel_colors(pixel_count, color(0, 0, 0));
+    vector<double> luminance_sums(pixel_count, 0.0);
+    vector<double> luminance_square_sums(pixel_count, 0.0);
 
-    // End render chrono
-    render_chrono->end();
+    // Batch buffers
+    int batch_size = std::max(1, wavefront_batch_size);
+    RayQueue queue;
+    queue.reserve(batch_size);
+    vector<int> path_pixels;
+    vector<color> path_radiance;
 
-    // Benchmark rays
-    rays_casted = primary_rays + reflected_rays + refracted_rays;
-    average_rays_per_second = rays_casted / render_chrono->elapsed_miliseconds();
+    // Walk the (pixel, sample) pairs of the tile in batches
+    int pixel = 0;
+    int sample_index = pixel_count > 0 ? first_samples[0] : 0;
+
+    while (pixel < pixel_count)
+    {
+        queue.clear();
+        path_pixels.clear();
+
+        // Generate the camera rays of the batch
+        while (pixel < pixel_count && queue.size() < batch_size)
+        {
+            int pixel_index = pixel_indices[pixel];
+            int pixel_row = pixel_index / image.width;
+            int pixel_column = pixel_index % image.width;
+
+            sampler.start_pixel_sample(pixel_index, sample_index);
+            auto sample_ray = get_ray_sample(pixel_row, pixel_column, sample_index, sampler);
+            stats.count_ray(CAMERA_RAY, 0);
+
+            queue.push(sample_ray, color(1, 1, 1), queue.size(), sampler);
+            path_pixels.push_back(pixel);
+
+            if (++sample_index >= last_samples[pixel] && ++pixel < pixel_count)
+                sample_index = first_samples[pixel];
+        }
+
+        // Trace the batch
+        path_radiance.assign(path_pixels.size(), color(0, 0, 0));
+        trace_wavefront(queue, path_radiance, scene);
+
+        // Gather the path radiance into the pixel sums
+        for (int path = 0; path < int(path_pixels.size()); path++)
+        {
+            int slot = path_pixels[path];
+            double luminance = display_luminance(path_radiance[path]);
+
+            pixel_colors[slot] += path_radiance[path];
+            luminance_sums[slot] += luminance;
+            luminance_square_sums[slot] += luminance * luminance;
+        }
+    }
+
+    // Accumulate the pass samples. Tiles never overlap, so no locking is needed.
+    int pixels_pending = 0;
+
+    for (int slot = 0; slot < pixel_count; slot++)
+    {
+        framebuffer.add_samples(pixel_indices[slot], pixel_colors[slot], luminance_sums[slot], luminance_square_sums[slot], last_samples[slot] - first_samples[slot]);
+
+        if (pixel_needs_samples(framebuffer, pixel_indices[slot], max_samples))
+            pixels_pending++;
+    }
+
+    return pixels_pending;
 }
 
+void Camera::trace_wavefront(RayQueue& queue, vector<color>& path_radiance, const Scene& scene)
+{
+    // Ray counters and sampling arena of the rendering thread
+    RayStats& stats = RayStats::local();
+    MemoryArena& arena = MemoryArena::local();
+
+    // Scene objects with specific PDFs
+    const auto& lights = scene.lights;
+
+    // Stage buffers
+    RayQueue next_queue;
+    next_queue.reserve(queue.size());
+    vector<Ray> rays;
+    vector<hit_record> hits;
+    vector<int> shading_order;
+
+    // Scene bounds that normalize the ray sort keys
+    AABB scene_bounds = sort_rays ? scene.world->bounding_box() : AABB::empty;
+
+    for (int depth = scene.bounce_max_depth; depth > 0 && !queue.empty(); depth--)
+    {
+        int bounce = scene.bounce_max_depth - depth + 1;
+        int queue_size = queue.size();
+
+        // Reorder the secondary rays so that queue neighbours start close together and head the same way
+        if (sort_rays && bounce > 1 && queue_size > 1)
+            sort_ray_queue(queue, scene_bounds);
+
+        rays.resize(queue_size);
+        hits.resize(queue_size);
+        shading_order.clear();
+
+        // Intersection stage: the whole queue against the scene
+        for (int i = 0; i < queue_size; i++)
+        {
+            Sampler& sampler = queue.samplers[i];
+            sampler.start_bounce(bounce);
+
+            rays[i] = queue.ray(i);
+            Interval ray_t(hit_epsilon(rays[i], scene.min_hit_distance), infinity);
+
+            if (scene.world->hit(rays[i], ray_t, hits[i], sampler))
+            {
+                shading_order.push_back(i);
+            }
+            else
+            {
+                color sky = scene.sky_blend ? sky_blend(rays[i]) : scene.background;
+                path_radiance[queue.path[i]] += queue.throughput(i) * sky;
+            }
+        }
+
+        // Bucket the hits by material so each shading run stays on the same material code and data
+        std::stable_sort(shading_order.begin(), shading_order.end(), [&](int a, int b)
+        {
+            return std::less<const Material*>()(hits[a].material, hits[b].material);
+        });
+
+        // Shading stage: emission, scattering and the next bounce queue. The PDFs of the previous stage are dead by now.
+        next_queue.clear();
+        arena.reset();
+
+        for (int i : shading_order)
+        {
+            const auto& sample_ray = rays[i];
+            const auto& rec = hits[i];
+            Sampler& sampler = queue.samplers[i];
+            color throughput = queue.throughput(i);
+            int path = queue.path[i];
+
+            switch (rec.type)
+            {
+            case TRIANGLE:
+            case QUAD:
+            case SPHERE:
+            case CONSTANT_MEDIUM:
+            {
+                // Emission
+                path_radiance[path] += throughput * rec.material->emitted(sample_ray, rec);
+
+                // If the ray does not scatter, it is emissive
+                scatter_record srec;
+                if (!rec.material->scatter(sample_ray, rec, srec, sampler))
+                    break;
 
-const shared_ptr<Ray> Camera::get_ray_sample(int pixel_row, int pixel_column, int sample_row, int sample_column) const
+                // Deal with specular materials apart from the rest (PDF skip)
+                if (srec.is_specular)
+                {
+                    if (depth - 1 > 0)
+                    {
+                        stats.count_ray(SPECULAR_RAY, sampler.bounce());
+                        next_queue.push(srec.specular_ray, throughput * srec.attenuation, path, sampler);
+                    }
+                    break;
+                }
+
+                // Create the sampling PDF
+                const PDF* sampling_pdf;
+
+                if (lights.empty())
+                    sampling_pdf = srec.pdf;
+                else
+                    sampling_pdf = arena.create<mixture_pdf>(arena.create<hittables_pdf>(lights, rec.p), srec.pdf);
+
+                // Generate random scatter ray using the sampling PDF and get its weight
+                vec3 scatter_direction = sampling_pdf->generate(sampler);
+                auto scattered = Ray(rec.p, scatter_direction, sample_ray.time());
+                auto sampling_pdf_value = sampling_pdf->value(scatter_direction, sampler);
+                auto scattering_pdf_value = rec.material->scattering_pdf_value(sample_ray, rec, scattered);
+
+                // Ray bounce
+                if (depth - 1 > 0)
+                {
+                    stats.count_ray(rec.material->get_type() == ISOTROPIC ? VOLUME_RAY : DIFFUSE_RAY, sampler.bounce());
+                    next_queue.push(scattered, throughput * srec.attenuation * scattering_pdf_value / sampling_pdf_value, path, sampler);
+                }
+                break;
+            }
+            default: // Unknown hit
+                path_radiance[path] += throughput * (scene.sky_blend ? sky_blend(sample_ray) : scene.background);
+                break;
+            }
+        }
+
+        std::swap(queue, next_queue);
+    }
+}
+
+void Camera::sort_ray_queue(RayQueue& queue, const AABB& bounds) const
+{
+    RayStats& stats = RayStats::local();
+
+    auto keys = queue.sort_keys(bounds);
+    vector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // Neighbouring rays that share their octant and coarse origin cell
+    auto coherent_pairs = [](const vector<uint64_t>& keys)
+    {
+        uint64_t pairs = 0;
+        for (size_t i = 1; i < keys.size(); i++)
+            pairs += (keys[i] >> ray_sort_coarse_shift) == (keys[i - 1] >> ray_sort_coarse_shift);
+        return pairs;
+    };
+
+    stats.ray_sort_coherent_before += coherent_pairs(keys);
+    radix_sort(keys, order, ray_sort_key_bits);
+    stats.ray_sort_coherent_after += coherent_pairs(keys);
+    stats.ray_sort_pairs += keys.size() - 1;
+    stats.rays_sorted += keys.size();
+
+    queue.permute(order);
+}
+
+void Camera::save_checkpoint(const Scene& scene, const ImageWriter& image) const
+{
+    checkpoint_header header;
+    header.config_hash = scene.config_hash(*this, image);
+    header.width = image.width;
+    header.height = image.height;
+    header.passes_rendered = passes_resumed + passes_rendered;
+    header.render_seconds = seconds_resumed + render_chrono->elapsed_seconds();
+
+    if (!Checkpoint::save(checkpoint_path, header, *image.framebuffer))
+        Logger::warn("CAMERA", "Could not write checkpoint: " + checkpoint_path);
+}
+
+bool Camera::renders_in_passes() const
+{
+    return progressive || adaptive || !checkpoint_path.empty();
+}
+
+bool Camera::pixel_needs_samples(const Framebuffer& framebuffer, int pixel_index, int max_samples) const
+{
+    int samples = framebuffer.samples(pixel_index);
+
+    if (samples >= max_samples)
+        return false;
+
+    // Adaptive sampling stops once the error estimate of a pixel with enough samples drops below the threshold
+    if (adaptive && samples >= std::max(2, adaptive_min_samples))
+        return framebuffer.standard_error(pixel_index) >= adaptive_threshold;
+
+    return true;
+}
+
+Ray Camera::get_ray_sample(int pixel_row, int pixel_column, int sample_index, Sampler& sampler) const
 {
-    auto offset = sample_square_stratified(sample_row, sample_column, pixel_sample_sqrt_inv);
+    // Stratified sample square of this sample. Sample counts above the strata count wrap around the grid.
+    int stratum = int((int64_t(sample_index) * stratum_stride) % pixel_strata);
+    int sample_row = stratum / pixel_sample_sqrt;
+    int sample_column = stratum % pixel_sample_sqrt;
+
+    auto offset = sample_square_stratified(sample_row, sample_column, pixel_sample_sqrt_inv, sampler);
 
     auto pixel_sample = pixel00_loc
         + ((pixel_row + offset.y) * pixel_delta_v)
         + ((pixel_column + offset.x) * pixel_delta_u);
 
-    auto ray_origin = (defocus_angle <= 0) ? lookfrom : defocus_disk_sample(lookfrom, defocus_disk_u, defocus_disk_v);
+    auto ray_origin = (defocus_angle <= 0) ? lookfrom : defocus_disk_sample(lookfrom, defocus_disk_u, defocus_disk_v, sampler);
     auto ray_direction = pixel_sample - ray_origin;
 
-    auto ray_time = random_double();
+    auto ray_time = sampler.random_double();
 
-    return make_shared<Ray>(ray_origin, ray_direction, ray_time);
+    return Ray(ray_origin, ray_direction, ray_time);
 }
 
-color Camera::ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scene& scene)
+color Camera::ray_color(const Ray& sample_ray, int depth, const Scene& scene, Sampler& sampler)
 {
     // If we've exceeded the ray bounce limit, no more light is gathered.
     if (depth <= 0)
         return color(0, 0, 0);
 
+    // Each bounce draws from its own random stream
+    sampler.start_bounce(scene.bounce_max_depth - depth + 1);
+
     // Intersection details and closest object hit by the ray
-    shared_ptr<hit_record> rec;
+    hit_record rec;
 
     // Define ray intersection interval
-    Interval ray_t(scene.min_hit_distance, infinity);
+    Interval ray_t(hit_epsilon(sample_ray, scene.min_hit_distance), infinity);
+
+    bool hit = scene.world->hit(sample_ray, ray_t, rec, sampler);
 
+    return shade_hit(sample_ray, hit ? &rec : nullptr, depth, scene, sampler);
+}
+
+color Camera::shade_hit(const Ray& sample_ray, const hit_record* rec, int depth, const Scene& scene, Sampler& sampler)
+{
     // Sky hit
-    if (!scene.intersect(sample_ray, ray_t, rec))
+    if (!rec)
         return scene.sky_blend ? sky_blend(sample_ray) : scene.background;
 
     // Hit object type
@@ -154,10 +723,10 @@ color Camera::ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scen
 
     // Material intersection point colors
     color color_from_scatter;
-    color color_from_emission = rec->material->emitted(sample_ray, rec);
+    color color_from_emission = rec->material->emitted(sample_ray, *rec);
 
     // Get scene objects with specific PDFs
-    auto hittables_with_pdf = scene.hittables_with_pdf;
+    const auto& lights = scene.lights;
 
     // Scattering record for pdf and attenuation management
     scatter_record srec;
@@ -168,50 +737,38 @@ color Camera::ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scen
     case TRIANGLE:
     {
         /*
-        std::shared_ptr<triangle_hit_record> tri_rec = std::dynamic_pointer_cast<triangle_hit_record>(rec);
-
-        if (tri_rec)
-        {
-            throw std::runtime_error("Error in hit record downcast to triangle hit record");
-            return color(0, 0, 0);
-        }
-
-        auto c = barycentric_color_interpolation(tri_rec, t);
+        auto c = barycentric_color_interpolation(*rec, t);
 
         if (c.has_value())
             return c.value();
 
-        return 0.5 * (tri_rec->normal + WHITE);
+        return 0.5 * (rec->normal + WHITE);
         */
     }
     case QUAD:
 
     case SPHERE:
+
+    case CONSTANT_MEDIUM:
     {
         // If the ray does not scatter, it is emissive
-        if (!rec->material->scatter(sample_ray, rec, srec))
+        if (!rec->material->scatter(sample_ray, *rec, srec, sampler))
             return color_from_emission;
 
         // Deal with specular materials apart from the rest (PDF skip)
         if (srec.is_specular)
         {
             if (depth - 1 > 0)
-            {
-                switch (srec.scatter_type)
-                {
-                case REFLECT: reflected_rays++; break;
-                case REFRACT: refracted_rays++; break;
-                }
-            }
+                RayStats::local().count_ray(SPECULAR_RAY, sampler.bounce());
 
-            return srec.attenuation * ray_color(srec.specular_ray, depth - 1, scene);
+            return srec.attenuation * ray_color(srec.specular_ray, depth - 1, scene, sampler);
         }
 
 
         // Create the sampling PDF
-        shared_ptr<PDF> sampling_pdf;
+        const PDF* sampling_pdf;
 
-        if (hittables_with_pdf.empty())
+        if (lights.empty())
         {
             // Material associated samplig PDF
             sampling_pdf = srec.pdf;
@@ -219,33 +776,28 @@ color Camera::ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scen
         else
         {
             // Generate mixture of PDFs
-            auto _hittables_pdf = make_shared<hittables_pdf>(hittables_with_pdf, rec->p);
-            auto _mixture_pdf = make_shared<mixture_pdf>(_hittables_pdf, srec.pdf);
+            auto& arena = MemoryArena::local();
+            auto _hittables_pdf = arena.create<hittables_pdf>(lights, rec->p);
+            auto _mixture_pdf = arena.create<mixture_pdf>(_hittables_pdf, srec.pdf);
             sampling_pdf = _mixture_pdf;
         }
 
         // Generate random scatter ray using the sampling PDF
         vec3 surface_hit_point = rec->p;
-        vec3 scatter_direction = sampling_pdf->generate();
-        auto scattered = make_shared<Ray>(surface_hit_point, scatter_direction, sample_ray->time());
+        vec3 scatter_direction = sampling_pdf->generate(sampler);
+        auto scattered = Ray(surface_hit_point, scatter_direction, sample_ray.time());
 
         // Get the weight of the generated scatter ray sample
-        auto sampling_pdf_value = sampling_pdf->value(scatter_direction);
+        auto sampling_pdf_value = sampling_pdf->value(scatter_direction, sampler);
 
         // Get the material's associated scattering PDF
-        auto scattering_pdf_value = rec->material->scattering_pdf_value(sample_ray, rec, scattered);
+        auto scattering_pdf_value = rec->material->scattering_pdf_value(sample_ray, *rec, scattered);
 
         // Ray bounce
         if (depth - 1 > 0)
-        {
-            switch (srec.scatter_type)
-            {
-            case REFLECT: reflected_rays++; break;
-            case REFRACT: refracted_rays++; break;
-            }
-        }
+            RayStats::local().count_ray(rec->material->get_type() == ISOTROPIC ? VOLUME_RAY : DIFFUSE_RAY, sampler.bounce());
 
-        color sample_color = ray_color(scattered, depth - 1, scene);
+        color sample_color = ray_color(scattered, depth - 1, scene, sampler);
 
         // Bidirectional Reflectance Distribution Function (BRDF)
         color_from_scatter = (srec.attenuation * scattering_pdf_value * sample_color) / sampling_pdf_value;
@@ -258,9 +810,9 @@ color Camera::ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scen
     }
 }
 
-color Camera::sky_blend(const shared_ptr<Ray>& r) const
+color Camera::sky_blend(const Ray& r) const
 {
-    vec3 unit_direction = unit_vector(r->direction());
+    vec3 unit_direction = unit_vector(r.direction());
 
     auto a = 0.5 * (unit_direction.y + 1.0);
     color start_color = WHITE;
@@ -269,13 +821,13 @@ color Camera::sky_blend(const shared_ptr<Ray>& r) const
     return lerp(a, start_color, end_color);
 }
 
-optional<color> Camera::barycentric_color_interpolation(const shared_ptr<triangle_hit_record>& rec, Triangle* t) const
+optional<color> Camera::barycentric_color_interpolation(const hit_record& rec, Triangle* t) const
 {
-    if (!rec->bc.has_value() || !t->has_vertex_colors())
+    if (rec.type != TRIANGLE || !t->has_vertex_colors())
         return nullopt;
 
     // Barycentric coordinates
-    barycentric_coordinates bc = rec->bc.value();
+    barycentric_coordinates bc = rec.bc;
     double u = bc.u;
     double v = bc.v;
     double w = bc.w;
@@ -3,6 +3,7 @@
 // Headers
 #include "vec3.hpp"
 #include "core.hpp"
+#include "ray_stats.hpp"
 
 // Forward declarations
 struct Chrono;
@@ -10,7 +11,18 @@ class Scene;
 class ImageWriter;
 class Ray;
 class Triangle;
-class triangle_hit_record;
+class Sampler;
+class hit_record;
+struct Tile;
+class Framebuffer;
+struct RayQueue;
+class AABB;
+
+enum INTEGRATOR
+{
+    RECURSIVE,  // Depth-first recursion, one path at a time
+    WAVEFRONT   // Breadth-first batches of paths traced bounce by bounce through structure-of-arrays ray queues
+};
 
 class Camera 
 {
@@ -29,18 +41,45 @@ public:
     point3 lookat = point3(0, 0, -1);   // Point camera is looking at
     vec3   world_up = vec3(0, 1, 0);    // Camera-relative "up" direction
 
+    // Render settings
+    int threads = 0;                    // Number of render threads (0 uses every hardware thread)
+    int tile_size = 16;                 // Side length in pixels of the square tiles handed to the render threads
+    INTEGRATOR integrator = RECURSIVE;  // Path tracing integrator
+    int wavefront_batch_size = 16384;   // Paths traced together per wavefront batch
+    bool sort_rays = false;             // Wavefront integrator: radix sorts secondary rays by direction octant and origin Morton code before intersecting them
+    int packet_size = 0;                // Camera rays traced together as a packet by the recursive integrator: 4 (2x2), 8 (4x2) or 16 (4x4) pixels. 0 traces single rays.
+
+    // Progressive render settings
+    bool progressive = false;           // Renders in passes until the time budget or the scene samples per pixel are reached
+    int samples_per_pass = 4;           // Samples added to every pixel per pass
+    double time_budget = 0;             // Wall-clock seconds the render may take (0 renders every sample). The first pass always completes.
+    double preview_interval = 0;        // Seconds between intermediate preview images (0 disables previews)
+
+    // Checkpoint settings
+    string checkpoint_path;             // File the render state is checkpointed to between passes (empty disables checkpointing)
+    double checkpoint_interval = 600;   // Seconds between checkpoints. A last one is always written when the render ends.
+    bool resume = false;                // Continues from a matching checkpoint at checkpoint_path instead of starting over
+
+    // Adaptive sampling settings
+    bool adaptive = false;              // Renders in passes and stops sampling pixels whose estimated error is below the threshold
+    double adaptive_threshold = 0.01;   // Standard error of the pixel mean display luminance, in [0,1] display units
+    int adaptive_min_samples = 16;      // Samples a pixel takes before its error estimate is trusted
+
     // Benchmark
-    int primary_rays = 0;
-    int reflected_rays = 0;
-    int refracted_rays = 0;
-    int rays_casted = 0;
-    int average_rays_per_second = 0;
+    RayStats ray_stats;                 // Ray counters of the last render, merged from every render thread
+    double mrays_per_second = 0.0;      // Million rays traced per second of render time
     shared_ptr<Chrono> render_chrono;
+    int passes_rendered = 0;            // Passes started by the last render
+    int passes_resumed = 0;             // Passes restored from the checkpoint the last render resumed from
+    double seconds_resumed = 0.0;       // Render time spent by the runs before the checkpoint the last render resumed from
+    bool budget_exhausted = false;      // Whether the last render was stopped by its time budget
 
     Camera();
 
     void initialize(const Scene& scene, const ImageWriter& image);
     void render(Scene& scene, ImageWriter& image);
+    void render(Scene& scene, ImageWriter& image, const Tile& region);   // Adds samples to the region pixels of the accumulation buffer, leaving the rest untouched
+    bool renders_in_passes() const;
 
 private:
 
@@ -53,11 +92,22 @@ private:
     vec3   defocus_disk_v;          // Defocus disk vertical radius    
 	int    pixel_sample_sqrt;	    // Square root of samples per pixel
 	double pixel_sample_sqrt_inv;   // Inverse of square root of samples per pixel
+    int    pixel_strata;            // Number of stratified sample squares per pixel
+    int    stratum_stride;          // Stride coprime with pixel_strata used to scatter consecutive samples over the strata
+    vector<RayStats> thread_stats;  // One ray counter block per render thread
 
-    const shared_ptr<Ray> get_ray_sample(int pixel_row, int pixel_column, int sample_row, int sample_column) const; // Construct a camera ray originating from the defocus disk and directed at randomly sampled point around the pixel location pixel_row, pixel_column for stratified sample square sample_row, sample_column.
-    color ray_color(const shared_ptr<Ray>& sample_ray, int depth, const Scene& scene);
-    color sky_blend(const shared_ptr<Ray>& r) const;
-    optional<color> barycentric_color_interpolation(const shared_ptr<triangle_hit_record>& rec, Triangle* t) const;
+    int render_tile(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image); // Adds up to pass_samples samples to every tile pixel that still needs them. Returns the pixels that still need samples afterwards.
+    int render_tile_packets(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image); // Same contract as render_tile, tracing the camera rays of neighbouring pixels as packets
+    int render_tile_wavefront(const Tile& tile, int pass_samples, int max_samples, const Scene& scene, ImageWriter& image); // Same contract as render_tile, tracing the samples in wavefront batches
+    void trace_wavefront(RayQueue& queue, vector<color>& path_radiance, const Scene& scene); // Traces the camera rays of the queue bounce by bounce, adding each path's radiance to path_radiance
+    void sort_ray_queue(RayQueue& queue, const AABB& bounds) const;
+    void save_checkpoint(const Scene& scene, const ImageWriter& image) const;
+    bool pixel_needs_samples(const Framebuffer& framebuffer, int pixel_index, int max_samples) const;
+    Ray get_ray_sample(int pixel_row, int pixel_column, int sample_index, Sampler& sampler) const; // Construct a camera ray originating from the defocus disk and directed at randomly sampled point around the pixel location pixel_row, pixel_column inside the stratified sample square of sample sample_index.
+    color ray_color(const Ray& sample_ray, int depth, const Scene& scene, Sampler& sampler);
+    color shade_hit(const Ray& sample_ray, const hit_record* rec, int depth, const Scene& scene, Sampler& sampler); // Color carried by sample_ray given its closest hit (nullptr for sky)
+    color sky_blend(const Ray& r) const;
+    optional<color> barycentric_color_interpolation(const hit_record& rec, Triangle* t) const;
 
 };
 
@@ -0,0 +1,56 @@
+﻿// Headers
+#include "core.hpp"
+#include "checkpoint.hpp"
+#include "framebuffer.hpp"
+
+bool Checkpoint::save(const string& path, const checkpoint_header& header, const Framebuffer& framebuffer)
+{
+    string temporary_path = path + ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (int pixel_index = 0; pixel_index < framebuffer.num_pixels(); pixel_index++)
+        {
+            PixelState state = framebuffer.pixel_state(pixel_index);
+            file.write(reinterpret_cast<const char*>(&state), sizeof(state));
+        }
+
+        if (!file)
+            return false;
+    }
+
+    std::error_code error;
+    fs::rename(temporary_path, path, error);
+
+    return !error;
+}
+
+bool Checkpoint::load(const string& path, uint64_t config_hash, Framebuffer& framebuffer, checkpoint_header& header)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    checkpoint_header expected;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!file || header.magic != expected.magic || header.version != expected.version || header.config_hash != config_hash
+        || header.width != framebuffer.width || header.height != framebuffer.height)
+        return false;
+
+    vector<PixelState> states(framebuffer.num_pixels());
+    file.read(reinterpret_cast<char*>(states.data()), std::streamsize(states.size() * sizeof(PixelState)));
+
+    if (!file)
+        return false;
+
+    for (int pixel_index = 0; pixel_index < framebuffer.num_pixels(); pixel_index++)
+        framebuffer.set_pixel_state(pixel_index, states[pixel_index]);
+
+    return true;
+}
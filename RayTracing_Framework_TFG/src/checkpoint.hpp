@@ -0,0 +1,31 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+// Forward declarations
+class Framebuffer;
+
+struct checkpoint_header
+{
+    uint32_t magic = 0x4B435452;        // "RTCK"
+    uint32_t version = 1;
+    uint64_t config_hash = 0;           // Scene::config_hash of the render that wrote it
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t passes_rendered = 0;        // Passes completed before the checkpoint
+    int32_t reserved = 0;               // Explicit padding so render_seconds stays 8-byte aligned and no uninitialized bytes reach the file
+    double render_seconds = 0.0;        // Render time spent before the checkpoint
+};
+
+static_assert(sizeof(checkpoint_header) == 40, "checkpoint_header must stay 40 bytes");
+
+class Checkpoint // Binary snapshot of an in-progress render: a header followed by the PixelState of every pixel
+{
+public:
+    // Writes to a temporary file first and then renames it over path, so a pre-empted write never corrupts the last checkpoint.
+    static bool save(const string& path, const checkpoint_header& header, const Framebuffer& framebuffer);
+
+    // Fails without touching the framebuffer if the file is missing, damaged or written by another scene or configuration.
+    static bool load(const string& path, uint64_t config_hash, Framebuffer& framebuffer, checkpoint_header& header);
+};
@@ -49,6 +49,16 @@ int Chrono::elapsed_miliseconds() const
     return int(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
 }
 
+double Chrono::elapsed_seconds() const
+{
+    auto elapsed = total_elapsed;
+
+    if (start_time.has_value())
+        elapsed += std::chrono::high_resolution_clock::now() - start_time.value();
+
+    return std::chrono::duration<double>(elapsed).count();
+}
+
 std::string Chrono::elapsed_to_string() const
 {
     auto et = elapsed();
@@ -24,6 +24,7 @@ public:
     void end();
     elapsed_time elapsed() const;
     int elapsed_miliseconds() const;
+    double elapsed_seconds() const;
     string elapsed_to_string() const;
 
     Chrono& operator+=(const Chrono& c);
@@ -27,3 +27,23 @@ tuple<int, int, int> compute_color(const color& pixel_color)
 
     return std::make_tuple(red_byte, green_byte, blue_byte);
 }
+
+double display_luminance(const color& pixel_color)
+{
+    auto r = pixel_color.x;
+    auto g = pixel_color.y;
+    auto b = pixel_color.z;
+
+    // Replace NaN components with zero
+    if (r != r) r = 0.0;
+    if (g != g) g = 0.0;
+    if (b != b) b = 0.0;
+
+    // Same gamma transform and clamping as compute_color
+    static const Interval intensity(0.000, 1.000);
+    r = intensity.clamp(linear_to_gamma(r));
+    g = intensity.clamp(linear_to_gamma(g));
+    b = intensity.clamp(linear_to_gamma(b));
+
+    return 0.2126 * r + 0.7152 * g + 0.0722 * b;
+}
@@ -29,5 +29,6 @@ inline double linear_to_gamma(double linear_component)
 }
 
 tuple<int, int, int> compute_color(const color& pixel_color);
+double display_luminance(const color& pixel_color);    // Rec. 709 luminance of the color as compute_color displays it, in [0,1]
 
 
@@ -8,48 +8,55 @@
 #include "aabb.hpp"
 
 constant_medium::constant_medium(shared_ptr<Hittable> boundary, double density, shared_ptr<Texture> tex) 
-    : boundary(boundary), neg_inv_density(-1 / density), phase_function(make_shared<Isotropic>(tex)) { }
+    : boundary(boundary), neg_inv_density(-1 / density), phase_function(make_shared<Isotropic>(tex))
+{
+    type = CONSTANT_MEDIUM;
+}
 
 constant_medium::constant_medium(shared_ptr<Hittable> boundary, double density, const color& albedo)
-    : boundary(boundary), neg_inv_density(-1 / density), phase_function(make_shared<Isotropic>(albedo)) { }
+    : boundary(boundary), neg_inv_density(-1 / density), phase_function(make_shared<Isotropic>(albedo))
+{
+    type = CONSTANT_MEDIUM;
+}
 
-bool constant_medium::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool constant_medium::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-    shared_ptr<hit_record> rec1, rec2;
+    hit_record rec1, rec2;
 
-    if (!boundary->hit(r, Interval::universe, rec1))
+    if (!boundary->hit(r, Interval::universe, rec1, sampler))
         return false;
 
-    if (!boundary->hit(r, Interval(rec1->t + 0.0001, infinity), rec2))
+    if (!boundary->hit(r, Interval(rec1.t + 0.0001, infinity), rec2, sampler))
         return false;
 
-    if (rec1->t < ray_t.min) rec1->t = ray_t.min;
-    if (rec2->t > ray_t.max) rec2->t = ray_t.max;
+    if (rec1.t < ray_t.min) rec1.t = ray_t.min;
+    if (rec2.t > ray_t.max) rec2.t = ray_t.max;
 
-    if (rec1->t >= rec2->t)
+    if (rec1.t >= rec2.t)
         return false;
 
-    if (rec1->t < 0)
-        rec1->t = 0;
+    if (rec1.t < 0)
+        rec1.t = 0;
 
-    auto ray_length = r->direction().length();
-    auto distance_inside_boundary = (rec2->t - rec1->t) * ray_length;
-    auto hit_distance = neg_inv_density * std::log(random_double());
+    auto ray_length = r.direction().length();
+    auto distance_inside_boundary = (rec2.t - rec1.t) * ray_length;
+    auto hit_distance = neg_inv_density * std::log(sampler.random_double());
 
     if (hit_distance > distance_inside_boundary)
         return false;
 
-    rec->t = rec1->t + hit_distance / ray_length;
-    rec->p = r->at(rec->t);
+    rec.t = rec1.t + hit_distance / ray_length;
+    rec.p = r.at(rec.t);
 
-    rec->normal = vec3(1, 0, 0);  // arbitrary
-    rec->front_face = true;     // also arbitrary
-    rec->material = phase_function;
+    rec.normal = vec3(1, 0, 0);  // arbitrary
+    rec.front_face = true;     // also arbitrary
+    rec.material = phase_function.get();
+    rec.type = type;
 
     return true;
 }
 
-shared_ptr<AABB> constant_medium::bounding_box() const 
+const AABB& constant_medium::bounding_box() const 
 { 
     return boundary->bounding_box(); 
 }
\ No newline at end of file
@@ -18,8 +18,8 @@ public:
     constant_medium(shared_ptr<Hittable> boundary, double density, shared_ptr<Texture> tex);
     constant_medium(shared_ptr<Hittable> boundary, double density, const color& albedo);
 
-    bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
-    shared_ptr<AABB> bounding_box() const override;
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+    const AABB& bounding_box() const override;
 
 private:
     shared_ptr<Hittable> boundary;
@@ -3,8 +3,19 @@
 // Headers
 #include "core.hpp"
 
+// Scalar type of the geometry, rays, bounding boxes and intersection math. Building with RT_SINGLE_PRECISION
+// defined switches it to float, which halves the size of vectors, boxes and BVH nodes.
+#ifdef RT_SINGLE_PRECISION
+using real = float;
+#else
+using real = double;
+#endif
+
 // Math
 constexpr double infinity = std::numeric_limits<double>::infinity();
 constexpr double pi = 3.1415926535897932385;
 constexpr double kEpsilon = 1e-8;
 constexpr double practically_zero = 1e-160;
+
+// Hit distances below this fraction of the largest ray origin coordinate are rounding error of the origin itself
+constexpr real hit_epsilon_scale = 64 * std::numeric_limits<real>::epsilon();
@@ -26,6 +26,15 @@
 #include <map>
 #include <type_traits>
 #include <utility>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <numeric>
+#include <bit>
+#include <cstring>
 #include <windows.h>
 
 // C++ std usings
@@ -0,0 +1,81 @@
+﻿// Headers
+#include "core.hpp"
+#include "cpu_features.hpp"
+
+// Platform Headers
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+const CPUFeatures& CPUFeatures::host()
+{
+    static const CPUFeatures features = detect();
+    return features;
+}
+
+CPUFeatures CPUFeatures::detect()
+{
+    CPUFeatures features;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    unsigned int leaf1[4] = {}, leaf7[4] = {};
+    uint64_t saved_state = 0;
+
+#if defined(_M_X64) || defined(_M_IX86)
+    int registers[4];
+    __cpuid(registers, 0);
+    int max_leaf = registers[0];
+
+    __cpuid(registers, 1);
+    std::memcpy(leaf1, registers, sizeof(leaf1));
+
+    if (max_leaf >= 7)
+    {
+        __cpuidex(registers, 7, 0);
+        std::memcpy(leaf7, registers, sizeof(leaf7));
+    }
+
+    if (leaf1[2] >> 27 & 1)
+        saved_state = _xgetbv(0);
+#else
+    unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+
+    __get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+
+    if (max_leaf >= 7)
+        __get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]);
+
+    if (leaf1[2] >> 27 & 1)
+    {
+        unsigned int low, high;
+        __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        saved_state = (uint64_t(high) << 32) | low;
+    }
+#endif
+
+    // The 256-bit extensions are only usable when the operating system saves both the SSE and the AVX register state
+    bool os_saves_ymm = (saved_state & 0x6) == 0x6;
+
+    features.sse2 = leaf1[3] >> 26 & 1;
+    features.sse41 = leaf1[2] >> 19 & 1;
+    features.avx = (leaf1[2] >> 28 & 1) && os_saves_ymm;
+    features.avx2 = features.avx && (leaf7[1] >> 5 & 1);
+#endif
+
+    return features;
+}
+
+string CPUFeatures::description() const
+{
+    string extensions;
+
+    for (auto [supported, name] : { pair<bool, const char*>(sse2, "SSE2"), { sse41, "SSE4.1" }, { avx, "AVX" }, { avx2, "AVX2" } })
+    {
+        if (supported)
+            extensions += extensions.empty() ? name : string(", ") + name;
+    }
+
+    return extensions.empty() ? "None" : extensions;
+}
@@ -0,0 +1,19 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+struct CPUFeatures // SIMD extensions of the host CPU, detected once so the kernels can pick their widest implementation at run time
+{
+public:
+    bool sse2 = false;
+    bool sse41 = false;
+    bool avx = false;   // Also requires the operating system to save the 256-bit registers
+    bool avx2 = false;
+
+    static const CPUFeatures& host();
+    string description() const;    // Supported extensions, or "None" off x86
+
+private:
+    static CPUFeatures detect();
+};
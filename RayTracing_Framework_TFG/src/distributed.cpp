@@ -0,0 +1,352 @@
+﻿// Headers
+#include "core.hpp"
+#include "distributed.hpp"
+#include "network.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "image_writer.hpp"
+#include "framebuffer.hpp"
+#include "scheduler.hpp"
+#include "ray_stats.hpp"
+#include "chrono.hpp"
+
+// Protocol
+enum MESSAGE_TYPE : uint32_t
+{
+    HELLO_MESSAGE = 1,  // Worker -> coordinator: scene/config hash
+    REJECT_MESSAGE,     // Coordinator -> worker: the hash does not match
+    TILE_MESSAGE,       // Coordinator -> worker: tile to render
+    RESULT_MESSAGE,     // Worker -> coordinator: tile, ray counters and pixel states of the tile
+    DONE_MESSAGE        // Coordinator -> worker: the frame is complete
+};
+
+struct message_header
+{
+    uint32_t magic = 0x52545446; // "FTTR"
+    uint32_t type = 0;
+    uint64_t size = 0;          // Payload bytes following the header
+};
+
+static bool send_message(Socket& socket, MESSAGE_TYPE type, const void* payload, size_t size)
+{
+    message_header header;
+    header.type = type;
+    header.size = size;
+
+    return socket.send_all(&header, sizeof(header)) && (size == 0 || socket.send_all(payload, size));
+}
+
+// Fails on payloads above max_size, the largest message the caller accepts, before allocating anything for them
+static bool receive_message(Socket& socket, MESSAGE_TYPE& type, vector<char>& payload, size_t max_size)
+{
+    message_header header;
+
+    if (!socket.receive_all(&header, sizeof(header)) || header.magic != message_header().magic || header.size > max_size)
+        return false;
+
+    type = MESSAGE_TYPE(header.type);
+    payload.resize(size_t(header.size));
+
+    return header.size == 0 || socket.receive_all(payload.data(), payload.size());
+}
+
+static int tile_pixels(const Tile& tile)
+{
+    return (tile.row_end - tile.row_start) * (tile.column_end - tile.column_start);
+}
+
+static bool tile_inside(const Tile& tile, int width, int height)
+{
+    return tile.row_start >= 0 && tile.row_start < tile.row_end && tile.row_end <= height
+        && tile.column_start >= 0 && tile.column_start < tile.column_end && tile.column_end <= width;
+}
+
+// ************** COORDINATOR ************** //
+
+RenderCoordinator::RenderCoordinator(int port) : port(port) {}
+
+void RenderCoordinator::render(Scene& scene, Camera& camera, ImageWriter& image)
+{
+    if (!Socket::startup())
+    {
+        string error = Logger::error("COORDINATOR", "Socket library could not be initialized.");
+        throw std::runtime_error(error);
+    }
+
+    Socket listener;
+    if (!listener.listen(port))
+    {
+        string error = Logger::error("COORDINATOR", std::format("Could not listen on port {}.", port));
+        throw std::runtime_error(error);
+    }
+
+    // Split the frame
+    TileScheduler splitter(image.width, image.height, tile_size, 1);
+    const vector<Tile>& tiles = splitter.get_tiles();
+    uint64_t config_hash = scene.config_hash(camera, image);
+
+    pending_tiles.clear();
+    for (const auto& tile : tiles)
+        pending_tiles.push_back(tile.index);
+
+    tiles_completed = 0;
+    workers_connected = 0;
+    camera.ray_stats.reset();
+    image.framebuffer->clear();
+
+    // Log info
+    Logger::info("COORDINATOR", std::format("Waiting for workers on port {} to render {} tiles.", port, tiles.size()));
+
+    // Start render chrono
+    camera.render_chrono->start();
+
+    // Accept workers until every tile is merged
+    vector<std::thread> connections;
+    int total_tiles = int(tiles.size());
+    int next_worker_id = 0;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+
+            if (tiles_completed == total_tiles)
+                break;
+
+            std::clog << "\rTiles remaining: " << (total_tiles - tiles_completed) << " (" << workers_connected << " workers) " << std::flush;
+        }
+
+        if (!listener.wait_readable(100))
+            continue;
+
+        Socket connection = listener.accept();
+        if (connection.valid())
+            connections.emplace_back(&RenderCoordinator::serve_worker, this, std::move(connection), next_worker_id++, config_hash, std::cref(tiles), std::ref(camera), std::ref(image));
+    }
+
+    std::clog << "\rTiles remaining: 0 " << std::endl;
+
+    // Wake idle connections so they release their workers
+    state_changed.notify_all();
+
+    for (auto& connection : connections)
+        connection.join();
+
+    // End render chrono
+    camera.render_chrono->end();
+
+    // Benchmark rays
+    auto render_seconds = camera.render_chrono->elapsed_seconds();
+    camera.mrays_per_second = render_seconds > 0.0 ? camera.ray_stats.total_rays() / render_seconds / 1e6 : 0.0;
+
+    // Convert the accumulated samples to the output image
+    image.resolve();
+
+    // Log info
+    Logger::info("COORDINATOR", std::format("All {} tiles merged.", total_tiles));
+}
+
+void RenderCoordinator::serve_worker(Socket connection, int worker_id, uint64_t config_hash, const vector<Tile>& tiles, Camera& camera, ImageWriter& image)
+{
+    MESSAGE_TYPE type;
+    vector<char> payload;
+
+    // Handshake
+    int timeout_milliseconds = worker_timeout * 1000;
+
+    if (!connection.wait_readable(timeout_milliseconds) || !receive_message(connection, type, payload, sizeof(uint64_t)) || type != HELLO_MESSAGE || payload.size() != sizeof(uint64_t))
+    {
+        Logger::warn("COORDINATOR", std::format("Worker {} sent an invalid handshake.", worker_id));
+        return;
+    }
+
+    uint64_t worker_hash;
+    std::memcpy(&worker_hash, payload.data(), sizeof(worker_hash));
+
+    if (worker_hash != config_hash)
+    {
+        Logger::warn("COORDINATOR", std::format("Worker {} rejected: its scene or settings differ from the coordinator ones.", worker_id));
+        send_message(connection, REJECT_MESSAGE, nullptr, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        workers_connected++;
+    }
+
+    Logger::info("COORDINATOR", std::format("Worker {} connected.", worker_id));
+
+    while (true)
+    {
+        // Take the next tile, waiting for reassigned ones while other workers still hold tiles
+        int tile_index;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            state_changed.wait(lock, [&] { return !pending_tiles.empty() || tiles_completed == int(tiles.size()); });
+
+            if (pending_tiles.empty())
+                break;
+
+            tile_index = pending_tiles.front();
+            pending_tiles.pop_front();
+        }
+
+        const Tile& tile = tiles[tile_index];
+        size_t pixels = size_t(tile_pixels(tile));
+        size_t result_size = sizeof(Tile) + sizeof(RayStats) + pixels * sizeof(PixelState);
+
+        // Assign it and wait for its result, which must start with the same tile
+        bool delivered = send_message(connection, TILE_MESSAGE, &tile, sizeof(Tile))
+            && connection.wait_readable(timeout_milliseconds)
+            && receive_message(connection, type, payload, result_size)
+            && type == RESULT_MESSAGE && payload.size() == result_size;
+
+        if (delivered)
+        {
+            Tile result_tile;
+            std::memcpy(&result_tile, payload.data(), sizeof(Tile));
+
+            delivered = result_tile.index == tile.index && result_tile.row_start == tile.row_start && result_tile.row_end == tile.row_end
+                && result_tile.column_start == tile.column_start && result_tile.column_end == tile.column_end;
+        }
+
+        if (!delivered)
+        {
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                pending_tiles.push_front(tile_index);
+                workers_connected--;
+            }
+            state_changed.notify_all();
+
+            Logger::warn("COORDINATOR", std::format("Worker {} lost. Tile {} goes back to the queue.", worker_id, tile_index));
+            return;
+        }
+
+        // Merge the tile
+        RayStats stats;
+        std::memcpy(&stats, payload.data() + sizeof(Tile), sizeof(RayStats));
+        const char* states = payload.data() + sizeof(Tile) + sizeof(RayStats);
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+
+            int pixel = 0;
+            for (int row = tile.row_start; row < tile.row_end; row++)
+            {
+                for (int column = tile.column_start; column < tile.column_end; column++, pixel++)
+                {
+                    PixelState state;
+                    std::memcpy(&state, states + pixel * sizeof(PixelState), sizeof(PixelState));
+                    image.framebuffer->set_pixel_state(image.width * row + column, state);
+                }
+            }
+
+            camera.ray_stats += stats;
+            tiles_completed++;
+        }
+        state_changed.notify_all();
+    }
+
+    // Release the worker
+    send_message(connection, DONE_MESSAGE, nullptr, 0);
+
+    std::lock_guard<std::mutex> lock(state_mutex);
+    workers_connected--;
+}
+
+// ************** WORKER ************** //
+
+RenderWorker::RenderWorker(const string& host, int port) : host(host), port(port) {}
+
+void RenderWorker::run(Scene& scene, Camera& camera, ImageWriter& image)
+{
+    if (!Socket::startup())
+    {
+        string error = Logger::error("WORKER", "Socket library could not be initialized.");
+        throw std::runtime_error(error);
+    }
+
+    // The coordinator may still be starting up
+    Socket connection;
+    for (int attempt = 0; attempt < 100 && !connection.connect(host, port); attempt++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    if (!connection.valid())
+    {
+        string error = Logger::error("WORKER", std::format("Could not connect to the coordinator at {}:{}.", host, port));
+        throw std::runtime_error(error);
+    }
+
+    Logger::info("WORKER", std::format("Connected to the coordinator at {}:{}.", host, port));
+
+    // Handshake
+    uint64_t config_hash = scene.config_hash(camera, image);
+    if (!send_message(connection, HELLO_MESSAGE, &config_hash, sizeof(config_hash)))
+    {
+        string error = Logger::error("WORKER", "Lost the coordinator during the handshake.");
+        throw std::runtime_error(error);
+    }
+
+    image.framebuffer->clear();
+
+    MESSAGE_TYPE type;
+    vector<char> payload;
+    vector<char> result;
+    int tiles_rendered = 0;
+
+    while (receive_message(connection, type, payload, sizeof(Tile)))
+    {
+        if (type == DONE_MESSAGE)
+        {
+            Logger::info("WORKER", std::format("Frame done after rendering {} tiles.", tiles_rendered));
+            return;
+        }
+
+        if (type == REJECT_MESSAGE)
+        {
+            string error = Logger::error("WORKER", "The coordinator rejected this worker: scene or settings differ.");
+            throw std::runtime_error(error);
+        }
+
+        if (type != TILE_MESSAGE || payload.size() != sizeof(Tile))
+            break;
+
+        Tile tile;
+        std::memcpy(&tile, payload.data(), sizeof(Tile));
+
+        if (!tile_inside(tile, image.width, image.height))
+        {
+            string error = Logger::error("WORKER", std::format("The coordinator sent a tile outside the {}x{} image.", image.width, image.height));
+            throw std::runtime_error(error);
+        }
+
+        // Render the tile
+        camera.render(scene, image, tile);
+
+        // Send the tile, its ray counters and its pixel states
+        result.resize(sizeof(Tile) + sizeof(RayStats) + size_t(tile_pixels(tile)) * sizeof(PixelState));
+        std::memcpy(result.data(), &tile, sizeof(Tile));
+        std::memcpy(result.data() + sizeof(Tile), &camera.ray_stats, sizeof(RayStats));
+
+        char* states = result.data() + sizeof(Tile) + sizeof(RayStats);
+        for (int row = tile.row_start; row < tile.row_end; row++)
+        {
+            for (int column = tile.column_start; column < tile.column_end; column++)
+            {
+                PixelState state = image.framebuffer->pixel_state(image.width * row + column);
+                std::memcpy(states, &state, sizeof(PixelState));
+                states += sizeof(PixelState);
+            }
+        }
+
+        if (!send_message(connection, RESULT_MESSAGE, result.data(), result.size()))
+            break;
+
+        tiles_rendered++;
+    }
+
+    string error = Logger::error("WORKER", "Lost the coordinator.");
+    throw std::runtime_error(error);
+}
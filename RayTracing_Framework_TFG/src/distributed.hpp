@@ -0,0 +1,48 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+// Forward declarations
+class Scene;
+class Camera;
+class ImageWriter;
+class Socket;
+struct Tile;
+
+// Both ends rebuild the same scene from scenes:: and exchange raw host-order binary messages, so every process of a
+// render must run the same build on the same architecture. The scene/config hash sent on connection guards the former.
+
+class RenderCoordinator // Splits the frame into tiles, hands them to worker processes over TCP and merges their results
+{
+public:
+    int port = 5557;                    // TCP port the workers connect to
+    int tile_size = 64;                 // Side length in pixels of the tiles handed to the workers
+    int worker_timeout = 600;           // Seconds a worker may stay silent during the handshake or a tile before it counts as lost
+
+    RenderCoordinator(int port);
+
+    // Blocks until every tile has been merged into the image accumulation buffer. Tiles of workers that disconnect
+    // before returning them go back to the queue for the remaining (or newly connected) workers.
+    void render(Scene& scene, Camera& camera, ImageWriter& image);
+
+private:
+    std::mutex state_mutex;
+    std::condition_variable state_changed;
+    std::deque<int> pending_tiles;
+    int tiles_completed = 0;
+    int workers_connected = 0;
+
+    void serve_worker(Socket connection, int worker_id, uint64_t config_hash, const vector<Tile>& tiles, Camera& camera, ImageWriter& image);
+};
+
+class RenderWorker // Renders the tiles a coordinator assigns and streams their float accumulation state back
+{
+public:
+    string host = "127.0.0.1";
+    int port = 5557;
+
+    RenderWorker(const string& host, int port);
+
+    void run(Scene& scene, Camera& camera, ImageWriter& image); // Returns once the coordinator reports the frame done
+};
@@ -0,0 +1,139 @@
+﻿// Headers
+#include "core.hpp"
+#include "framebuffer.hpp"
+
+Framebuffer::Framebuffer() {}
+
+void Framebuffer::initialize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    accumulation.assign(3 * size_t(width) * height, 0.0f);
+    luminance_sums.assign(size_t(width) * height, 0.0f);
+    luminance_squares.assign(size_t(width) * height, 0.0f);
+    sample_counts.assign(size_t(width) * height, 0);
+}
+
+void Framebuffer::clear()
+{
+    std::fill(accumulation.begin(), accumulation.end(), 0.0f);
+    std::fill(luminance_sums.begin(), luminance_sums.end(), 0.0f);
+    std::fill(luminance_squares.begin(), luminance_squares.end(), 0.0f);
+    std::fill(sample_counts.begin(), sample_counts.end(), 0);
+}
+
+void Framebuffer::add_samples(int pixel_index, const color& sample_sum, double luminance_sum, double luminance_square_sum, int sample_count)
+{
+    float* pixel = &accumulation[3 * size_t(pixel_index)];
+    pixel[0] += float(sample_sum.x);
+    pixel[1] += float(sample_sum.y);
+    pixel[2] += float(sample_sum.z);
+    luminance_sums[pixel_index] += float(luminance_sum);
+    luminance_squares[pixel_index] += float(luminance_square_sum);
+    sample_counts[pixel_index] += sample_count;
+}
+
+color Framebuffer::average(int pixel_index) const
+{
+    auto count = sample_counts[pixel_index];
+
+    if (count == 0)
+        return color(0, 0, 0);
+
+    const float* pixel = &accumulation[3 * size_t(pixel_index)];
+    return color(pixel[0], pixel[1], pixel[2]) / double(count);
+}
+
+int Framebuffer::samples(int pixel_index) const
+{
+    return int(sample_counts[pixel_index]);
+}
+
+PixelState Framebuffer::pixel_state(int pixel_index) const
+{
+    PixelState state;
+    state.color_sum[0] = accumulation[3 * size_t(pixel_index) + 0];
+    state.color_sum[1] = accumulation[3 * size_t(pixel_index) + 1];
+    state.color_sum[2] = accumulation[3 * size_t(pixel_index) + 2];
+    state.luminance_sum = luminance_sums[pixel_index];
+    state.luminance_square_sum = luminance_squares[pixel_index];
+    state.samples = sample_counts[pixel_index];
+    return state;
+}
+
+void Framebuffer::set_pixel_state(int pixel_index, const PixelState& state)
+{
+    accumulation[3 * size_t(pixel_index) + 0] = state.color_sum[0];
+    accumulation[3 * size_t(pixel_index) + 1] = state.color_sum[1];
+    accumulation[3 * size_t(pixel_index) + 2] = state.color_sum[2];
+    luminance_sums[pixel_index] = state.luminance_sum;
+    luminance_squares[pixel_index] = state.luminance_square_sum;
+    sample_counts[pixel_index] = state.samples;
+}
+
+double Framebuffer::standard_error(int pixel_index) const
+{
+    double count = sample_counts[pixel_index];
+
+    if (count < 2)
+        return infinity;
+
+    // Unbiased sample variance of the display luminance
+    double mean = luminance_sums[pixel_index] / count;
+    double variance = (luminance_squares[pixel_index] - count * mean * mean) / (count - 1);
+
+    return std::sqrt(std::max(variance, 0.0) / count);
+}
+
+int Framebuffer::num_pixels() const
+{
+    return width * height;
+}
+
+int Framebuffer::min_samples() const
+{
+    if (sample_counts.empty()) return 0;
+    return int(*std::min_element(sample_counts.begin(), sample_counts.end()));
+}
+
+int Framebuffer::max_samples() const
+{
+    if (sample_counts.empty()) return 0;
+    return int(*std::max_element(sample_counts.begin(), sample_counts.end()));
+}
+
+uint64_t Framebuffer::total_samples() const
+{
+    uint64_t total = 0;
+
+    for (auto count : sample_counts)
+        total += count;
+
+    return total;
+}
+
+size_t Framebuffer::memory_bytes() const
+{
+    return accumulation.capacity() * sizeof(float) + luminance_sums.capacity() * sizeof(float)
+        + luminance_squares.capacity() * sizeof(float) + sample_counts.capacity() * sizeof(uint32_t);
+}
+
+vector<int> Framebuffer::sample_histogram() const
+{
+    vector<int> histogram;
+
+    for (auto count : sample_counts)
+    {
+        int bucket = 0;
+        while ((uint64_t(2) << bucket) <= count)
+            bucket++;
+
+        if (bucket >= int(histogram.size()))
+            histogram.resize(bucket + 1, 0);
+
+        histogram[bucket]++;
+    }
+
+    return histogram;
+}
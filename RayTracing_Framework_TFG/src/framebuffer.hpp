@@ -0,0 +1,46 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "vec3.hpp"
+
+struct PixelState // Raw accumulation state of one pixel, as moved between framebuffers and processes
+{
+    float color_sum[3];
+    float luminance_sum;
+    float luminance_square_sum;
+    uint32_t samples;
+};
+
+class Framebuffer // 32-bit float accumulation buffer that keeps the running sums and sample count of every pixel
+{
+public:
+    int width = 0;
+    int height = 0;
+
+    Framebuffer();
+
+    void initialize(int width, int height);
+    void clear();
+
+    // Render threads only ever touch the pixels of their own tile, so these need no locking.
+    void add_samples(int pixel_index, const color& sample_sum, double luminance_sum, double luminance_square_sum, int sample_count);
+    color average(int pixel_index) const;   // Mean color of the samples accumulated so far (black if there are none)
+    int samples(int pixel_index) const;
+    PixelState pixel_state(int pixel_index) const;
+    void set_pixel_state(int pixel_index, const PixelState& state);
+    double standard_error(int pixel_index) const; // Estimated standard error of the mean display luminance (infinity below two samples)
+
+    int num_pixels() const;
+    int min_samples() const;
+    int max_samples() const;
+    uint64_t total_samples() const;
+    size_t memory_bytes() const;            // Bytes reserved by the accumulation buffers
+    vector<int> sample_histogram() const;   // Pixel count per power of two bucket: bucket b holds the pixels with [2^b, 2^(b+1)) samples (bucket 0 also holds unsampled pixels)
+
+private:
+    vector<float> accumulation;             // RGB sums in row-major order
+    vector<float> luminance_sums;           // Display luminance sums of the samples
+    vector<float> luminance_squares;        // Squared display luminance sums of the samples
+    vector<uint32_t> sample_counts;         // Samples accumulated per pixel
+};
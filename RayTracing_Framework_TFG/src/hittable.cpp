@@ -2,6 +2,8 @@
 #include "core.hpp"
 #include "hittable.hpp"
 #include "utilities.hpp"
+#include "interval.hpp"
+#include "ray_packet.hpp"
 
 void hit_record::determine_normal_direction(const vec3& ray_direction, const vec3& outward_normal)
 {
@@ -10,32 +12,34 @@ void hit_record::determine_normal_direction(const vec3& ray_direction, const vec
     normal = front_face ? outward_normal : -outward_normal;
 }
 
-sphere_hit_record::sphere_hit_record()
-{
-    type = SPHERE;
-}
+const shared_ptr<Matrix44> Hittable::identity_model = make_shared<Matrix44>(Matrix44::identity());
 
-triangle_hit_record::triangle_hit_record() : bc(nullopt)
+Hittable::Hittable()
 {
-    type = TRIANGLE;
-}
 
-quad_hit_record::quad_hit_record()
-{
-    type = QUAD;
 }
 
-Hittable::Hittable()
+void Hittable::hit_packet(RayPacket& packet, uint32_t active) const
 {
+    for (int i = 0; i < packet.size; i++)
+    {
+        if (!(active >> i & 1))
+            continue;
 
+        if (hit(packet.rays[i], Interval(packet.t_min[i], packet.t_max[i]), packet.records[i], *packet.samplers[i]))
+        {
+            packet.hits |= 1u << i;
+            packet.t_max[i] = packet.records[i].t;
+        }
+    }
 }
 
-double Hittable::pdf_value(const point3& hit_point, const vec3& scattering_direction) const
+double Hittable::pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const
 {
     return 0.0;
 }
 
-vec3 Hittable::random_scattering_ray(const point3& hit_point) const
+vec3 Hittable::random_scattering_ray(const point3& hit_point, Sampler& sampler) const
 {
     return vec3(1, 0, 0);
 }
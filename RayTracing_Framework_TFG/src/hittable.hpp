@@ -4,12 +4,13 @@
 #include "core.hpp"
 #include "vec3.hpp"
 #include "matrix.hpp"
+#include "aabb.hpp"
 
 // Forward declarations
 class Material;
 class Ray;
-class Interval;
-class AABB;
+class Sampler;
+struct RayPacket;
 
 enum PRIMITIVE
 {
@@ -19,6 +20,8 @@ enum PRIMITIVE
     BOX,
     MESH,
     BVH_NODE,
+    LINEAR_BVH,
+    CONSTANT_MEDIUM,
 	NOT_SPECIFIED
 };
 
@@ -27,58 +30,40 @@ struct barycentric_coordinates
 	double u, v, w;
 };
 
-class hit_record 
+class hit_record // Fixed-size closest hit data. Owned by the caller and filled in place by the primitive hit functions.
 {
 public:
     point3 p;
     vec3 normal;
-    double t;
-    bool front_face;
-    shared_ptr<Material> material;
+    real t = 0;
+    bool front_face = false;
+    const Material* material = nullptr;                 // Non-owning, the scene keeps the materials alive
     pair<double, double> texture_coordinates;
+    barycentric_coordinates bc = { 0.0, 0.0, 0.0 };     // Only meaningful for TRIANGLE hits
     PRIMITIVE type = NOT_SPECIFIED;
 
-    virtual ~hit_record() = default; 
-
     void determine_normal_direction(const vec3& ray_direction, const vec3& outward_normal);     // Sets the hit record normal vector direction.
 };
 
-class sphere_hit_record : public hit_record
-{
-public:
-    sphere_hit_record();
-};
-
-class triangle_hit_record : public hit_record
-{
-public:
-	optional<barycentric_coordinates> bc;
-
-    triangle_hit_record();
-};
-
-class quad_hit_record : public hit_record
-{
-public:
-    quad_hit_record();
-};
-
 class Hittable
 {
 public:
     Hittable();
     virtual ~Hittable() = default;
 
-    virtual bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const = 0;
-    virtual shared_ptr<AABB> bounding_box() const = 0;
-    virtual double pdf_value(const point3& hit_point, const vec3& scattering_direction) const;
-    virtual vec3 random_scattering_ray(const point3& hit_point) const;
+    virtual bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const = 0;
+    virtual const AABB& bounding_box() const = 0;
+    virtual void hit_packet(RayPacket& packet, uint32_t active) const; // Closest hit search for the active rays of a packet. Defaults to one hit call per ray.
+    virtual double pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const;
+    virtual vec3 random_scattering_ray(const point3& hit_point, Sampler& sampler) const;
     const PRIMITIVE get_type() const;
     const bool has_pdf() const;
 
 protected:
     PRIMITIVE type = NOT_SPECIFIED;
-    shared_ptr<Matrix44> model = make_shared<Matrix44>(Matrix::identity(4));
+    shared_ptr<Matrix44> model = identity_model;
+
+    static const shared_ptr<Matrix44> identity_model;  // Shared by every hittable without its own model matrix
     bool pdf = false;
 };
 
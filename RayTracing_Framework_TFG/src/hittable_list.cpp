@@ -3,6 +3,8 @@
 #include "hittable_list.hpp"
 #include "interval.hpp"
 #include "hittable.hpp"
+#include "ray_packet.hpp"
+#include "ray_stats.hpp"
 
 hittable_list::hittable_list() {}
 
@@ -27,25 +29,32 @@ size_t hittable_list::size() const
     return objects.size();
 }
 
-bool hittable_list::intersect(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool hittable_list::intersect(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-    shared_ptr<hit_record> temp_rec = make_shared<hit_record>();
     bool hit_anything = false;
     auto closest_object_so_far = ray_t.max;
 
+    // Objects only write the record when they find a hit closer than closest_object_so_far, so it can be filled in place
     for (const auto& object : objects)
     {
-        if (object->hit(r, Interval(ray_t.min, closest_object_so_far), temp_rec))
+        if (object->hit(r, Interval(ray_t.min, closest_object_so_far), rec, sampler))
         {
             hit_anything = true;
-            closest_object_so_far = temp_rec->t;
-            rec = temp_rec;
+            closest_object_so_far = rec.t;
         }
     }
 
     return hit_anything;
 }
 
+void hittable_list::intersect_packet(RayPacket& packet) const
+{
+    RayStats::local().packets_traced++;
+
+    for (const auto& object : objects)
+        object->hit_packet(packet, packet.all_active());
+}
+
 shared_ptr<Hittable> hittable_list::operator[](int i) const
 {
     return objects[i];
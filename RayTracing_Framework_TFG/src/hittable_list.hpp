@@ -8,6 +8,8 @@ class Hittable;
 class Ray;
 class Interval;
 class hit_record;
+class Sampler;
+struct RayPacket;
 
 class hittable_list
 {
@@ -20,7 +22,8 @@ public:
     virtual void add(shared_ptr<Hittable> object);
     void clear();
 	size_t size() const;
-    bool intersect(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const;
+    bool intersect(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const;
+    void intersect_packet(RayPacket& packet) const;   // Closest hit of every packet ray, left in packet.records
   
 	shared_ptr<Hittable> operator[](int i) const;
 };
@@ -26,10 +26,16 @@ ImageReader::ImageReader(const char* image_filename)
     Logger::error("ImageReader", "Could not load image file: " + string(image_filename));
 }
 
+// Bytes held by the pixel buffers of all the loaded images
+static std::atomic<size_t> image_bytes = 0;
+
 ImageReader::ImageReader() {}
 
 ImageReader::~ImageReader()
 {
+    if (fdata != nullptr)
+        image_bytes -= size_t(image_width) * image_height * bytes_per_pixel * (sizeof(float) + sizeof(unsigned char));
+
     delete[] bdata;
     STBI_FREE(fdata);
 }
@@ -60,6 +66,9 @@ bool ImageReader::load(const std::string& filename)
     bytes_per_scanline = image_width * bytes_per_pixel;
     convert_to_bytes();
 
+    // Both the float and the byte copies of the image stay in memory
+    image_bytes += size_t(image_width) * image_height * bytes_per_pixel * (sizeof(float) + sizeof(unsigned char));
+
     return true;
 }
 
@@ -76,6 +85,11 @@ const unsigned char* ImageReader::pixel_data(int x, int y) const
     return bdata + y * bytes_per_scanline + x * bytes_per_pixel;
 }
 
+size_t ImageReader::loaded_bytes()
+{
+    return image_bytes;
+}
+
 int ImageReader::clamp(int x, int low, int high)
 {
     // Return the value clamped to the range [low, high).
@@ -29,6 +29,8 @@ public:
     bool load(const string& filename);
     const unsigned char* pixel_data(int x, int y) const;
 
+    static size_t loaded_bytes();   // Bytes held by the float and byte buffers of every loaded image
+
 private:
     const int       bytes_per_pixel = 3;
     float*          fdata = nullptr;         // Linear floating point pixel data
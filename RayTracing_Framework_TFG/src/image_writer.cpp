@@ -3,6 +3,8 @@
 #include "image_writer.hpp"
 #include "utilities.hpp"
 #include "chrono.hpp"
+#include "framebuffer.hpp"
+#include "color.hpp"
 
 // Macros
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -14,6 +16,7 @@
 ImageWriter::ImageWriter()
 {
     encoding_chrono = make_shared<Chrono>();
+    framebuffer = make_shared<Framebuffer>();
 }
 
 void ImageWriter::initialize()
@@ -45,6 +48,9 @@ void ImageWriter::initialize()
     // Reserve space for image data pointer
     data.resize(3 * width * height);
 
+    // Allocate the accumulation buffer
+    framebuffer->initialize(width, height);
+
     // Log info
     Logger::info("ImageWriter", "Image frame succesfully initialized.");
 }
@@ -59,6 +65,12 @@ void ImageWriter::write_pixel(int pixel_position, tuple<int, int, int> RGB_color
     data[pixel_position + 2] = blue_byte;
 }
 
+void ImageWriter::resolve()
+{
+    for (int pixel_index = 0; pixel_index < framebuffer->num_pixels(); pixel_index++)
+        write_pixel(3 * pixel_index, compute_color(framebuffer->average(pixel_index)));
+}
+
 void ImageWriter::save()
 {
     // Get current date and time
@@ -79,10 +91,10 @@ void ImageWriter::save()
     switch (format)
     {
     case PNG:
-        success = savePNG();
+        success = savePNG(image_path);
         break;
     case JPG:
-        success = saveJPG(quality);
+        success = saveJPG(image_path, quality);
         break;
     }
 
@@ -96,14 +108,40 @@ void ImageWriter::save()
     size = make_shared<file_size>(get_file_size(image_path));
 }
 
-bool ImageWriter::savePNG()
+void ImageWriter::save_preview()
+{
+    // Previews always overwrite the same file so jobs can poll it
+    string preview_path = output_path + "preview" + format_str;
+
+    bool success = false;
+
+    switch (format)
+    {
+    case PNG:
+        success = savePNG(preview_path);
+        break;
+    case JPG:
+        success = saveJPG(preview_path, quality);
+        break;
+    }
+
+    if (!success)
+        Logger::warn("ImageWriter", "Failed to write preview image: preview" + format_str);
+}
+
+size_t ImageWriter::buffer_bytes() const
+{
+    return data.capacity() * sizeof(unsigned char);
+}
+
+bool ImageWriter::savePNG(const string& path)
 {
-    int success = stbi_write_png(image_path.c_str(), width, height, channels, data.data(), width * channels);
+    int success = stbi_write_png(path.c_str(), width, height, channels, data.data(), width * channels);
     return success;
 }
 
-bool ImageWriter::saveJPG(int quality)
+bool ImageWriter::saveJPG(const string& path, int quality)
 {
-    int success = stbi_write_jpg(image_path.c_str(), width, height, channels, data.data(), quality);
+    int success = stbi_write_jpg(path.c_str(), width, height, channels, data.data(), quality);
     return success;
 }
@@ -6,6 +6,7 @@
 // Forward declarations
 struct file_size;
 struct Chrono;
+class Framebuffer;
 
 enum IMAGE_FORMAT
 {
@@ -28,19 +29,23 @@ public:
     double aspect_ratio = 16.0 / 9.0;       // Ratio of image width over height
     shared_ptr<file_size> size;             // Output image file size
     shared_ptr<Chrono> encoding_chrono;     // Chrono to measure the image encoding time using stb_image_write
+    shared_ptr<Framebuffer> framebuffer;    // 32-bit float accumulation buffer the renderer adds its samples to
 
     ImageWriter();
 
     void initialize();
     void write_pixel(int pixel_position, tuple<int, int, int> RGB_color);
+    void resolve();                         // Converts the accumulated samples into the 8-bit image buffer
     void save();
+    void save_preview();                    // Overwrites the preview image with the current image buffer
+    size_t buffer_bytes() const;            // Bytes reserved by the 8-bit image buffer
    
 private:
     vector<unsigned char> data;             // Image buffer
     int channels = 3;                       // RGB channels
 
-    bool savePNG();
-    bool saveJPG(int quality);
+    bool savePNG(const string& path);
+    bool saveJPG(const string& path, int quality);
 };
 
  
@@ -2,28 +2,7 @@
 #include "core.hpp"
 #include "interval.hpp"
 
-Interval::Interval() 
-{
-    min = +infinity;
-    max = -infinity;
-}
-
-Interval::Interval(double min, double max)
-{
-    if (min > max)
-        std::swap(min, max);
-
-    this->min = min;
-    this->max = max;
-}
-
-Interval::Interval(const Interval& a, const Interval& b)
-{
-    min = a.min <= b.min ? a.min : b.min;
-    max = a.max >= b.max ? a.max : b.max;
-}
-
-double Interval::size() const
+real Interval::size() const
 {
     return max - min;
 }
@@ -33,30 +12,30 @@ bool Interval::is_empty() const
     return size() > 0.0;
 }
 
-bool Interval::contains(double x) const
+bool Interval::contains(real x) const
 {
     return min <= x && x <= max;
 }
 
-bool Interval::surrounds(double x) const
+bool Interval::surrounds(real x) const
 {
     return min < x && x < max;
 }
 
-double Interval::clamp(double x) const
+real Interval::clamp(real x) const
 {
     if (x < min) return min;
     if (x > max) return max;
     return x;
 }
 
-Interval Interval::expand(double delta) const
+Interval Interval::expand(real delta) const
 {
     auto padding = delta / 2;
     return Interval(min - padding, max + padding);
 }
 
 // Static members
-const Interval Interval::empty = Interval(+infinity, -infinity);
+const Interval Interval::empty = Interval();   // The two-bound constructor would reorder the bounds into the universe interval
 const Interval Interval::universe = Interval(-infinity, +infinity);
 const Interval Interval::unitary = Interval(0.0, 1.0);
\ No newline at end of file
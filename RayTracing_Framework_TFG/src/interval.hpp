@@ -1,40 +1,52 @@
 ﻿#pragma once
 
+// Headers
+#include "constants.hpp"
+
 class Interval 
 {
 public:
-    double min, max;
+    real min, max;
     static const Interval empty, universe, unitary;
 
-    Interval(); // Default interval is empty
-    Interval(double min, double max);
-    Interval(const Interval& a, const Interval& b); // Creates the interval tightly enclosing the two input intervals.
+    constexpr Interval(); // Default interval is empty
+    constexpr Interval(real min, real max);
+    constexpr Interval(const Interval& a, const Interval& b); // Creates the interval tightly enclosing the two input intervals.
 
-    double size() const;
+    real size() const;
     bool is_empty() const;
-    bool contains(double x) const;
-    bool surrounds(double x) const;
-    double clamp(double x) const;
-    Interval expand(double delta) const;
+    bool contains(real x) const;
+    bool surrounds(real x) const;
+    real clamp(real x) const;
+    Interval expand(real delta) const;
 };
 
+// Constexpr constructors, so the static intervals are constant-initialized before any other static object reads them
+constexpr Interval::Interval() : min(+infinity), max(-infinity) {}
+
+constexpr Interval::Interval(real min, real max) : min(min > max ? max : min), max(min > max ? min : max) {}
+
+constexpr Interval::Interval(const Interval& a, const Interval& b)
+    : min(a.min <= b.min ? a.min : b.min), max(a.max >= b.max ? a.max : b.max)
+{}
+
 // Operator overlaods
-inline Interval operator+(const Interval& ival, double displacement) 
+inline Interval operator+(const Interval& ival, real displacement) 
 {
     return Interval(ival.min + displacement, ival.max + displacement);
 }
 
-inline Interval operator+(double displacement, const Interval& ival) 
+inline Interval operator+(real displacement, const Interval& ival) 
 {
     return ival + displacement;
 }
 
-inline Interval operator*(const Interval& ival, double displacement) 
+inline Interval operator*(const Interval& ival, real displacement) 
 {
     return Interval(ival.min * displacement, ival.max * displacement);
 }
 
-inline Interval operator*(double displacement, const Interval& ival) 
+inline Interval operator*(real displacement, const Interval& ival) 
 {
     return ival * displacement;
 }
@@ -0,0 +1,333 @@
+﻿// Headers
+#include "core.hpp"
+#include "linear_bvh.hpp"
+#include "bvh.hpp"
+#include "chrono.hpp"
+#include "logger.hpp"
+#include "ray.hpp"
+#include "ray_stats.hpp"
+#include "ray_packet.hpp"
+
+void linear_bvh_node::set_bounds(const AABB& box)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const Interval& interval = box.axis_interval(axis);
+
+        // Round outwards whenever the conversion to single precision moved a bound into the box
+        float min = float(interval.min);
+        float max = float(interval.max);
+        bounds_min[axis] = (double(min) > double(interval.min)) ? std::nextafter(min, -std::numeric_limits<float>::infinity()) : min;
+        bounds_max[axis] = (double(max) < double(interval.max)) ? std::nextafter(max, std::numeric_limits<float>::infinity()) : max;
+    }
+}
+
+AABB linear_bvh_node::bounds() const
+{
+    return AABB(Interval(bounds_min[0], bounds_max[0]), Interval(bounds_min[1], bounds_max[1]), Interval(bounds_min[2], bounds_max[2]));
+}
+
+uint8_t linear_bvh_node::split_axis(const AABB& first, const AABB& second)
+{
+    vec3 separation = second.centroid() - first.centroid();
+    real x = std::fabs(separation.x), y = std::fabs(separation.y), z = std::fabs(separation.z);
+
+    if (x > y)
+        return x > z ? 0 : 2;
+    else
+        return y > z ? 1 : 2;
+}
+
+LinearBVH::LinearBVH(shared_ptr<bvh_node> root, const BVHSettings& settings) : root(root)
+{
+    type = LINEAR_BVH;
+
+    chrono = make_shared<Chrono>();
+    chrono->start();
+
+    nodes.reserve(root->nodes + 1);
+    flatten(*root, 0);
+    nodes.shrink_to_fit();
+    primitives.shrink_to_fit();
+
+    if (settings.node_width() > 2)
+        wide_nodes.build(nodes, settings.node_width(), settings.simd);
+
+    chrono->end();
+
+    bbox = root->bounding_box();
+}
+
+uint32_t LinearBVH::flatten(const Hittable& object, int node_depth)
+{
+    if (node_depth >= linear_bvh_stack_size)
+    {
+        string error = Logger::error("LINEAR_BVH", "The BVH is too deep for the traversal stack of the flattened tree.");
+        throw std::length_error(error);
+    }
+
+    // Nodes are appended in depth-first order, so the first child of an interior node directly follows it
+    uint32_t node_index = uint32_t(nodes.size());
+    nodes.emplace_back();
+    nodes[node_index].set_bounds(object.bounding_box());
+    nodes[node_index].offset = uint32_t(primitives.size());
+    nodes[node_index].count = 0;
+    nodes[node_index].axis = 0;
+    nodes[node_index].padding = 0;
+    _depth = std::max(_depth, node_depth);
+
+    // Any other hittable ends in a leaf of its own
+    if (object.get_type() != BVH_NODE)
+    {
+        primitives.push_back(&object);
+        nodes[node_index].count = 1;
+        return node_index;
+    }
+
+    const auto& node = static_cast<const bvh_node&>(object);
+
+    if (!node.leaf.empty())
+    {
+        for (const auto& leaf_object : node.leaf)
+            primitives.push_back(leaf_object.get());
+
+        nodes[node_index].count = uint16_t(node.leaf.size());
+        return node_index;
+    }
+
+    // A node over one or two objects that are not nodes themselves becomes a leaf as well
+    if (node.left->get_type() != BVH_NODE && node.right->get_type() != BVH_NODE)
+    {
+        primitives.push_back(node.left.get());
+        if (node.right != node.left)
+            primitives.push_back(node.right.get());
+
+        nodes[node_index].count = uint16_t(primitives.size() - nodes[node_index].offset);
+        return node_index;
+    }
+
+    // The child lying lower along the split axis goes first, so the traversal can pick the near child from the direction sign
+    const Hittable* first = node.left.get();
+    const Hittable* second = node.right.get();
+    uint8_t axis = linear_bvh_node::split_axis(first->bounding_box(), second->bounding_box());
+
+    if (first->bounding_box().centroid()[axis] > second->bounding_box().centroid()[axis])
+        std::swap(first, second);
+
+    flatten(*first, node_depth + 1);
+    uint32_t second_index = flatten(*second, node_depth + 1);
+
+    nodes[node_index].offset = second_index;
+    nodes[node_index].axis = axis;
+
+    return node_index;
+}
+
+bool LinearBVH::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
+{
+    if (wide_nodes.empty())
+        return hit_subtree(0, r, ray_t, rec, sampler);
+
+    return wide_nodes.hit(r, ray_t, [&](uint32_t first, uint32_t count, Interval& interval)
+    {
+        bool hit_anything = false;
+
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            if (primitives[i]->hit(r, interval, rec, sampler))
+            {
+                hit_anything = true;
+                interval.max = rec.t;
+            }
+        }
+
+        return hit_anything;
+    });
+}
+
+bool LinearBVH::hit_subtree(uint32_t node_index, const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
+{
+    RayStats& stats = RayStats::local();
+
+    const point3& origin = r.origin();
+    const vec3& direction = r.direction();
+    vec3 inverse_direction(1 / direction.x, 1 / direction.y, 1 / direction.z);
+    bool direction_negative[3] = { direction.x < 0, direction.y < 0, direction.z < 0 };
+
+    // Far children waiting to be visited
+    uint32_t stack[linear_bvh_stack_size];
+    int stack_size = 0;
+    bool hit_anything = false;
+
+    while (true)
+    {
+        const linear_bvh_node& node = nodes[node_index];
+        stats.bvh_nodes_visited++;
+
+        // The box test uses the closest hit so far, which culls far children behind it
+        if (node.hit(origin, inverse_direction, ray_t.min, ray_t.max))
+        {
+            if (node.count == 0)
+            {
+                if (direction_negative[node.axis])
+                {
+                    stack[stack_size++] = node_index + 1;
+                    node_index = node.offset;
+                }
+                else
+                {
+                    stack[stack_size++] = node.offset;
+                    node_index++;
+                }
+
+                continue;
+            }
+
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+            {
+                if (primitives[i]->hit(r, ray_t, rec, sampler))
+                {
+                    hit_anything = true;
+                    ray_t.max = rec.t;
+                }
+            }
+        }
+
+        if (stack_size == 0)
+            break;
+
+        node_index = stack[--stack_size];
+    }
+
+    return hit_anything;
+}
+
+void LinearBVH::hit_packet(RayPacket& packet, uint32_t active) const
+{
+    RayStats& stats = RayStats::local();
+
+    // Inverse directions of the packet rays, computed once for the whole traversal
+    array<vec3, ray_packet_max_size> inverse_directions;
+    for (int i = 0; i < packet.size; i++)
+    {
+        const vec3& direction = packet.rays[i].direction();
+        inverse_directions[i] = vec3(1 / direction.x, 1 / direction.y, 1 / direction.z);
+    }
+
+    // Far children waiting to be visited, with the rays of the packet that entered their parent
+    struct StackEntry
+    {
+        uint32_t node_index;
+        uint32_t active;
+    };
+
+    StackEntry stack[linear_bvh_stack_size];
+    int stack_size = 0;
+    StackEntry current = { 0, active };
+
+    while (true)
+    {
+        const linear_bvh_node& node = nodes[current.node_index];
+        stats.packet_nodes_visited++;
+
+        // Rays of the packet that enter the box
+        uint32_t inside = 0;
+        int inside_count = 0;
+
+        // Reject the whole packet at once when interval arithmetic proves every ray misses the box
+        if (!packet.may_hit(node.bounds(), current.active))
+        {
+            stats.packet_nodes_culled++;
+        }
+        else
+        {
+            for (int i = 0; i < packet.size; i++)
+            {
+                if ((current.active >> i & 1) && node.hit(packet.rays[i].origin(), inverse_directions[i], packet.t_min[i], packet.t_max[i]))
+                {
+                    inside |= 1u << i;
+                    inside_count++;
+                }
+            }
+        }
+
+        if (inside != 0)
+        {
+            // Once the packet has diverged, the remaining rays are cheaper to trace on their own
+            if (inside_count * 4 <= packet.size)
+            {
+                for (int i = 0; i < packet.size; i++)
+                {
+                    if (!(inside >> i & 1))
+                        continue;
+
+                    stats.packet_fallback_rays++;
+
+                    hit_record& rec = packet.records[i];
+
+                    if (hit_subtree(current.node_index, packet.rays[i], Interval(packet.t_min[i], packet.t_max[i]), rec, *packet.samplers[i]))
+                    {
+                        packet.hits |= 1u << i;
+                        packet.t_max[i] = rec.t;
+                    }
+                }
+            }
+            else if (node.count > 0)
+            {
+                for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+                    primitives[i]->hit_packet(packet, inside);
+            }
+            else
+            {
+                // Coherent packets share direction signs, so the first ray entering the box picks the near child
+                int first_ray = 0;
+                while (!(inside >> first_ray & 1))
+                    first_ray++;
+
+                bool negative = packet.rays[first_ray].direction()[node.axis] < 0;
+
+                uint32_t near_index = negative ? node.offset : current.node_index + 1;
+                uint32_t far_index = negative ? current.node_index + 1 : node.offset;
+
+                stack[stack_size++] = { far_index, inside };
+                current = { near_index, inside };
+                continue;
+            }
+        }
+
+        if (stack_size == 0)
+            break;
+
+        current = stack[--stack_size];
+    }
+}
+
+const AABB& LinearBVH::bounding_box() const
+{
+    return bbox;
+}
+
+const shared_ptr<Chrono> LinearBVH::bvh_chrono() const
+{
+    return chrono;
+}
+
+size_t LinearBVH::num_nodes() const
+{
+    return nodes.size();
+}
+
+int LinearBVH::depth() const
+{
+    return _depth;
+}
+
+size_t LinearBVH::memory_bytes() const
+{
+    return nodes.capacity() * sizeof(linear_bvh_node) + wide_nodes.memory_bytes() + primitives.capacity() * sizeof(const Hittable*);
+}
+
+const WideBVH& LinearBVH::wide() const
+{
+    return wide_nodes;
+}
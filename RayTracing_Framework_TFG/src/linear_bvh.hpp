@@ -0,0 +1,87 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "hittable.hpp"
+#include "aabb.hpp"
+#include "bvh_split.hpp"
+#include "wide_bvh.hpp"
+
+// Forward declarations
+class bvh_node;
+struct Chrono;
+
+// Macros
+constexpr int linear_bvh_stack_size = 64;   // Traversal stack entries, bounding the depth of flattened trees
+
+struct alignas(32) linear_bvh_node // 32-byte node of a flat depth-first BVH. The first child of an interior node always directly follows it.
+{
+    float bounds_min[3];    // Box rounded outwards to single precision, so it still encloses the box it was built from
+    float bounds_max[3];
+    uint32_t offset;        // Leaf: first primitive of the leaf. Interior: index of the second child.
+    uint16_t count;         // Number of primitives of a leaf, 0 for interior nodes
+    uint8_t axis;           // Interior: axis along which the first child lies below the second one
+    uint8_t padding;
+
+    void set_bounds(const AABB& box);
+    AABB bounds() const;
+
+    // Axis with the largest distance between the centroids of two child boxes
+    static uint8_t split_axis(const AABB& first, const AABB& second);
+
+    // Slab test with the inverse ray direction computed once per ray, with the same comparisons as AABB::hit
+    bool hit(const point3& origin, const vec3& inverse_direction, real t_min, real t_max) const
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            real t0 = (real(bounds_min[axis]) - origin[axis]) * inverse_direction[axis];
+            real t1 = (real(bounds_max[axis]) - origin[axis]) * inverse_direction[axis];
+
+            if (t0 < t1)
+            {
+                if (t0 > t_min) t_min = t0;
+                if (t1 < t_max) t_max = t1;
+            }
+            else
+            {
+                if (t1 > t_min) t_min = t1;
+                if (t0 < t_max) t_max = t0;
+            }
+
+            if (t_max <= t_min)
+                return false;
+        }
+
+        return true;
+    }
+};
+
+static_assert(sizeof(linear_bvh_node) == 32, "linear_bvh_node must stay 32 bytes");
+
+class LinearBVH : public Hittable // Flattened copy of a bvh_node tree in one contiguous node array, traversed iteratively near child first
+{
+public:
+    LinearBVH(shared_ptr<bvh_node> root, const BVHSettings& settings = BVHSettings());   // Also collapses the nodes into a wide BVH unless the node width is 2
+
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+    const AABB& bounding_box() const override;
+    void hit_packet(RayPacket& packet, uint32_t active) const override;
+    const shared_ptr<Chrono> bvh_chrono() const;
+
+    size_t num_nodes() const;
+    int depth() const;
+    size_t memory_bytes() const;    // Node arrays and primitive table
+    const WideBVH& wide() const;
+
+private:
+    shared_ptr<bvh_node> root;              // Keeps the objects of the primitive table alive
+    vector<linear_bvh_node> nodes;
+    vector<const Hittable*> primitives;     // Objects of the leaves in leaf order, every leaf reads a contiguous range
+    WideBVH wide_nodes;                     // Traced by single rays when built. Packets keep tracing the binary nodes.
+    AABB bbox;
+    int _depth = 0;
+    shared_ptr<Chrono> chrono;
+
+    uint32_t flatten(const Hittable& object, int node_depth);
+    bool hit_subtree(uint32_t node_index, const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const;
+};
@@ -13,6 +13,10 @@
 #include "mesh.hpp"
 #include "chrono.hpp"
 #include "image_writer.hpp"
+#include "framebuffer.hpp"
+#include "memory_stats.hpp"
+#include "linear_bvh.hpp"
+#include "cpu_features.hpp"
 
 LogWriter::LogWriter()
 {
@@ -37,6 +41,7 @@ void LogWriter::write(const Scene& scene, const Camera& camera, const ImageWrite
     // System Section
     log << "## System 🖥️\n\n";
     log << "**Platform:** " << SystemInfo::platform << "  \n";
+    log << "**SIMD Extensions:** " << CPUFeatures::host().description() << "  \n";
     log << "**CPU Threads Used:** " << SystemInfo::cpu_threads << "  \n\n";
 
     // Project Section
@@ -44,6 +49,7 @@ void LogWriter::write(const Scene& scene, const Camera& camera, const ImageWrite
     log << "**Raytracer Version:** " << ProjectInfo::version << "  \n";
     log << "**Build Configuration:** " << ProjectInfo::build_configuration << "  \n";
     log << "**Compiler:** " << ProjectInfo::compiler << "  \n";
+    log << "**Geometry Precision:** " << (std::is_same_v<real, float> ? "float32" : "float64") << "  \n";
     log << "**Start Time:** " << scene._start << "  \n";
     log << "**End Time:** " << scene._end << "  \n";
     log << "**Elapsed time:** " << scene.full_pipeline->elapsed_to_string() << "\n\n";
@@ -70,7 +76,21 @@ void LogWriter::write(const Scene& scene, const Camera& camera, const ImageWrite
     log << "## BVH 🍂\n\n";
     log << "**Main Depth:** " << scene.bvh_depth << "  \n";
     log << "**Main Nodes:** " << scene.bvh_nodes << "  \n";
-    log << "**BVHs Build Time:** " << scene.bvh_chrono->elapsed_to_string() << "\n\n";
+    log << "**Split Method:** " << scene.bvh_settings.description() << "  \n";
+    if (scene.linear_bvh && !scene.linear_bvh->wide().empty())
+        log << "**Layout:** Flattened and collapsed, " << scene.linear_bvh->wide().description() << "  \n";
+    else if (scene.linear_bvh)
+        log << "**Layout:** Flattened, " << scene.linear_bvh->num_nodes() << " nodes of " << sizeof(linear_bvh_node) << " bytes, depth " << scene.linear_bvh->depth() << ", near child first  \n";
+    else
+        log << "**Layout:** Pointer tree, left child first  \n";
+    log << "**Main SAH Cost:** " << std::fixed << std::setprecision(2) << scene.bvh_sah_cost << std::defaultfloat << "  \n";
+    if (scene.bvh_settings.compare_splits)
+    {
+        log << "**Main SAH Cost with " << (scene.bvh_settings.split == SAH_SPLIT ? "Median" : "SAH") << " Split:** " << std::fixed << std::setprecision(2) << scene.bvh_alternative_sah_cost;
+        log << " (" << std::showpos << 100.0 * (scene.bvh_alternative_sah_cost / std::max(scene.bvh_sah_cost, 1e-12) - 1.0) << std::noshowpos << "% expected traversal time)  \n" << std::defaultfloat;
+    }
+    int build_threads = scene.bvh_settings.build_thread_count();
+    log << "**BVHs Build Time:** " << scene.bvh_chrono->elapsed_to_string() << " (" << build_threads << (build_threads == 1 ? " thread)" : " threads)") << "\n\n";
 
     // Primitives
     log << "## Primitives 🔵\n\n";
@@ -79,15 +99,48 @@ void LogWriter::write(const Scene& scene, const Camera& camera, const ImageWrite
     log << "**Triangles:** " << scene.triangles << "  \n";
     log << "**Total:** " << scene.primitives << "  \n\n";
 
+    // Memory
+    MemoryStats memory = MemoryStats::collect(scene, image);
+    auto bytes = [](uint64_t amount)
+    {
+        file_size size = format_bytes(amount);
+        std::ostringstream text;
+        text << size.amount << " " << size.unit;
+        return text.str();
+    };
+
+    log << "## Memory 🧠\n\n";
+    log << "**Primitives:** " << bytes(memory.primitives()) << "\n";
+    log << "    - **Spheres:** " << bytes(memory.spheres) << "  \n";
+    log << "    - **Quads:** " << bytes(memory.quads) << "  \n";
+    log << "    - **Triangles:** " << bytes(memory.triangles) << "  \n";
+    log << "**BVH Nodes:** " << bytes(memory.bvh_nodes) << "  \n";
+    log << "**Bounding Boxes:** " << bytes(memory.bounding_boxes) << " (inside primitives and BVH nodes)  \n";
+    log << "**Mesh Vertex Data:** " << bytes(memory.mesh_vertices) << "  \n";
+    log << "**Mesh Index Data:** " << bytes(memory.mesh_indices) << "  \n";
+    log << "**Textures:** " << bytes(memory.textures) << "  \n";
+    log << "**Framebuffer:** " << bytes(memory.framebuffer) << "  \n";
+    log << "**Image Buffer:** " << bytes(memory.image_buffer) << "  \n";
+    log << "**Render Arenas:** " << bytes(memory.render_arenas) << "  \n";
+    log << "**Total Accounted:** " << bytes(memory.total()) << "  \n";
+    log << "**Peak Resident Memory:** " << bytes(memory.peak_resident) << "  \n\n";
+
     // Meshes
     log << "## Meshes 🔺\n\n";
     for (auto mesh : scene.meshes)
     {
         log << "· `" << mesh->name() << "`:\n";
         log << "    - **Total Triangles:** " << mesh->num_triangles() << "  \n";
+        log << "    - **Vertices:** " << mesh->num_vertices() << "  \n";
         log << "    - **Surfaces:** " << mesh->num_surfaces() << "  \n";
         log << "    - **Textures:** " << to_list(mesh->texture_names()) << "  \n";
-        log << "    - **BVH build time:** " << mesh->bvh_chrono()->elapsed_to_string() << " \n";
+        const BVHSettings& mesh_bvh_settings = mesh->get_geometry().get_bvh_settings();
+        int mesh_build_threads = mesh_bvh_settings.build_thread_count();
+        log << "    - **BVH Split Method:** " << mesh_bvh_settings.description() << "  \n";
+        log << "    - **BVH build time:** " << mesh->bvh_chrono()->elapsed_to_string() << " (" << mesh_build_threads << (mesh_build_threads == 1 ? " thread)" : " threads)") << " \n";
+        log << "    - **BVH SAH Cost:** " << std::fixed << std::setprecision(2) << mesh->get_geometry().bvh_sah_cost() << std::defaultfloat << "  \n";
+        if (!mesh->get_geometry().wide_bvh().empty())
+            log << "    - **BVH Layout:** " << mesh->get_geometry().wide_bvh().description() << "  \n";
     }
     log << "\n";
 
@@ -102,12 +155,79 @@ void LogWriter::write(const Scene& scene, const Camera& camera, const ImageWrite
     // Render Benchmark
     log << "## Render Benchmark 🎇\n\n";
     log << "**Rendering Time:** " << camera.render_chrono->elapsed_to_string() << " \n";
+    log << "**Integrator:** " << (camera.integrator == WAVEFRONT ? std::format("Wavefront ({} paths per batch)", camera.wavefront_batch_size) : "Recursive") << "  \n";
+    log << "**Mode:** " << (camera.progressive ? "Progressive" : camera.adaptive ? "Adaptive" : camera.renders_in_passes() ? "Checkpointed passes" : "Single pass") << "  \n";
+    if (camera.renders_in_passes())
+    {
+        log << "    - **Samples per Pass:** " << camera.samples_per_pass << "  \n";
+        log << "    - **Time Budget:** " << (camera.progressive && camera.time_budget > 0 ? std::format("{}s", camera.time_budget) : "None") << "  \n";
+        log << "    - **Passes:** " << camera.passes_rendered << (camera.budget_exhausted ? " (stopped by time budget)" : "") << "  \n";
+        if (!camera.checkpoint_path.empty())
+            log << "    - **Checkpoint:** `" << camera.checkpoint_path << "`" << (camera.passes_resumed > 0 ? std::format(" (resumed after {} passes and {:.1f}s)", camera.passes_resumed, camera.seconds_resumed) : "") << "  \n";
+    }
+    log << "**Samples per Pixel Reached:** " << image.framebuffer->min_samples() << " - " << image.framebuffer->max_samples() << "  \n";
+    log << "**Adaptive Sampling:** " << (camera.adaptive ? "Enabled" : "Disabled") << "  \n";
+    if (camera.adaptive)
+    {
+        uint64_t uniform_samples = uint64_t(scene.samples_per_pixel) * image.framebuffer->num_pixels();
+        uint64_t taken_samples = image.framebuffer->total_samples();
+        uint64_t saved_samples = uniform_samples > taken_samples ? uniform_samples - taken_samples : 0;
+
+        log << "    - **Error Threshold:** " << camera.adaptive_threshold << "  \n";
+        log << "    - **Minimum Samples:** " << camera.adaptive_min_samples << "  \n";
+        log << "    - **Mean Samples per Pixel:** " << std::fixed << std::setprecision(2) << double(taken_samples) / image.framebuffer->num_pixels() << std::defaultfloat << "  \n";
+        log << "    - **Samples Saved:** " << saved_samples << " of " << uniform_samples << " (" << std::fixed << std::setprecision(1) << 100.0 * saved_samples / std::max<uint64_t>(uniform_samples, 1) << std::defaultfloat << "%)  \n";
+        log << "    - **Samples per Pixel Distribution:**\n";
+
+        auto histogram = image.framebuffer->sample_histogram();
+        for (int bucket = 0; bucket < int(histogram.size()); bucket++)
+        {
+            if (histogram[bucket] == 0)
+                continue;
+
+            int first = bucket == 0 ? 0 : 1 << bucket;
+            int last = (2 << bucket) - 1;
+            log << "        - **" << first << " - " << last << " spp:** " << histogram[bucket] << " pixels  \n";
+        }
+    }
     log << "**Rays:**\n";
-    log << "    - **Primary Rays:** " << camera.primary_rays << "  \n";
-    log << "    - **Reflected Rays:** " << camera.reflected_rays << "  \n";
-    log << "    - **Refracted Rays:** " << camera.refracted_rays << "  \n";
-    log << "    - **Total Rays Casted:** " << camera.rays_casted << "  \n";
-    log << "    - **Average Rays per Second:** " << camera.average_rays_per_second << "  \n\n";
+    for (int kind = 0; kind < RAY_KINDS; kind++)
+        log << "    - **" << RayStats::kind_name(RAY_KIND(kind)) << " Rays:** " << camera.ray_stats.rays_by_kind[kind] << "  \n";
+    log << "    - **Total Rays Casted:** " << camera.ray_stats.total_rays() << "  \n";
+    log << "    - **Throughput:** " << std::fixed << std::setprecision(3) << camera.mrays_per_second << std::defaultfloat << " Mrays/s  \n";
+    log << "**Rays per Bounce:**\n";
+    for (int depth = 0; depth <= camera.ray_stats.max_depth_reached(); depth++)
+        log << "    - **Bounce " << depth << (depth == ray_stats_max_depth - 1 ? "+" : "") << ":** " << camera.ray_stats.rays_by_depth[depth] << "  \n";
+    if (ray_stats_count_allocations)
+    {
+        log << "**Allocations:**\n";
+        log << "    - **Heap Allocations:** " << camera.ray_stats.allocations << "  \n";
+        log << "    - **Allocations per Sample:** " << std::fixed << std::setprecision(2) << double(camera.ray_stats.allocations) / std::max<uint64_t>(camera.ray_stats.rays_by_kind[CAMERA_RAY], 1) << std::defaultfloat << "  \n";
+    }
+    else
+        log << "**Allocations:** Not counted (build with RT_COUNT_ALLOCATIONS)  \n";
+    log << "**Traversal:**\n";
+    log << "    - **BVH Nodes Visited:** " << camera.ray_stats.bvh_nodes_visited << "  \n";
+    log << "    - **Primitives Tested:** " << camera.ray_stats.primitives_tested << "  \n";
+    if (camera.packet_size > 1 && camera.integrator == RECURSIVE)
+    {
+        log << "**Camera Ray Packets:** " << camera.packet_size << " rays  \n";
+        log << "    - **Packets Traced:** " << camera.ray_stats.packets_traced << "  \n";
+        log << "    - **Packet Nodes Visited:** " << camera.ray_stats.packet_nodes_visited << "  \n";
+        log << "    - **Packet Nodes Culled:** " << camera.ray_stats.packet_nodes_culled << "  \n";
+        log << "    - **Fallback Rays:** " << camera.ray_stats.packet_fallback_rays << "  \n";
+    }
+    if (camera.sort_rays && camera.integrator == WAVEFRONT)
+    {
+        auto pairs = std::max<uint64_t>(camera.ray_stats.ray_sort_pairs, 1);
+
+        log << "**Ray Sorting:**\n";
+        log << "    - **Rays Sorted:** " << camera.ray_stats.rays_sorted << "  \n";
+        log << "    - **Coherent Neighbours Before Sorting:** " << std::fixed << std::setprecision(1) << 100.0 * camera.ray_stats.ray_sort_coherent_before / pairs << "%  \n";
+        log << "    - **Coherent Neighbours After Sorting:** " << 100.0 * camera.ray_stats.ray_sort_coherent_after / pairs << std::defaultfloat << "%  \n";
+        log << "    - **BVH Nodes Visited per Ray:** " << std::fixed << std::setprecision(2) << double(camera.ray_stats.bvh_nodes_visited) / std::max<uint64_t>(camera.ray_stats.total_rays(), 1) << std::defaultfloat << "  \n";
+    }
+    log << "\n";
 
     // Log messages
     log << "## Log 📋\n\n";
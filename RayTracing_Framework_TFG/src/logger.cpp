@@ -62,11 +62,13 @@ string Logger::info(string location, string description)
 
 vector<LogMessage> Logger::messages()
 {
+    std::lock_guard<std::mutex> lock(messages_mutex);
     return _messages;
 }
 
 void Logger::clear()
 {
+    std::lock_guard<std::mutex> lock(messages_mutex);
     _messages.clear();
 }
 
@@ -81,10 +83,12 @@ LogMessage Logger::new_message(log_message_type type, string& location, string&
     message.location = "[" + location + "]";
     message.description = "\"" + description + "\"";
 
+    std::lock_guard<std::mutex> lock(messages_mutex);
     _messages.push_back(message);
     return message;
 }
 
 // Static members
 vector<LogMessage> Logger::_messages;
+std::mutex Logger::messages_mutex;
 
@@ -36,6 +36,7 @@ public:
 private:
 
     static vector<LogMessage> _messages;
+    static std::mutex messages_mutex;      // Render coordinator threads log concurrently
 
     static LogMessage new_message(log_message_type type, string& location, string& description);
 };
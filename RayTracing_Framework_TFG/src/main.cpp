@@ -5,9 +5,58 @@
 #include "camera.hpp"
 #include "image_writer.hpp"
 #include "log_writer.hpp"
+#include "distributed.hpp"
 
-int main()
+// Command line options:
+//   --coordinator <port>       Render the frame on worker processes connecting to this port
+//   --worker <host> <port>     Render tiles for the coordinator listening at host:port
+//   --threads <count>          Render threads of this process (defaults to every hardware thread)
+//   --checkpoint <path>        Checkpoint a local render to path between passes
+//   --resume                   Continue a local render from its checkpoint
+int main(int argc, char* argv[])
 {
+    // Parse command line
+    enum { LOCAL, COORDINATOR, WORKER } mode = LOCAL;
+    string host = "127.0.0.1";
+    int port = 5557;
+    int threads = -1;
+    string checkpoint_path;
+    bool resume = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+
+        if (option == "--coordinator" && i + 1 < argc)
+        {
+            mode = COORDINATOR;
+            port = std::atoi(argv[++i]);
+        }
+        else if (option == "--worker" && i + 2 < argc)
+        {
+            mode = WORKER;
+            host = argv[++i];
+            port = std::atoi(argv[++i]);
+        }
+        else if (option == "--threads" && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (option == "--checkpoint" && i + 1 < argc)
+        {
+            checkpoint_path = argv[++i];
+        }
+        else if (option == "--resume")
+        {
+            resume = true;
+        }
+        else
+        {
+            Logger::error("MAIN", "Unknown or incomplete option: " + option);
+            return 1;
+        }
+    }
+
     // Create render objects
     Scene scene;
     Camera camera;
@@ -20,14 +69,47 @@ int main()
     // Build scene
     scene.build(camera, image);
 
+    // Command line overrides
+    if (threads >= 0)
+        camera.threads = threads;
+
+    if (!checkpoint_path.empty() || resume)
+    {
+        if (mode == LOCAL)
+        {
+            camera.checkpoint_path = checkpoint_path.empty() ? camera.checkpoint_path : checkpoint_path;
+            camera.resume = resume;
+        }
+        else
+        {
+            Logger::warn("MAIN", "Checkpoints only apply to local renders. Ignoring --checkpoint and --resume.");
+        }
+    }
+
     // Intialize image
     image.initialize();
 
     // Initialize the camera
     camera.initialize(scene, image);
 
+    // Workers only stream tiles back to the coordinator
+    if (mode == WORKER)
+    {
+        RenderWorker worker(host, port);
+        worker.run(scene, camera, image);
+        return 0;
+    }
+
     // Render scene
-    camera.render(scene, image);
+    if (mode == COORDINATOR)
+    {
+        RenderCoordinator coordinator(port);
+        coordinator.render(scene, camera, image);
+    }
+    else
+    {
+        camera.render(scene, image);
+    }
 
     // Encode and save image with desired format
     image.save();
@@ -38,4 +120,3 @@ int main()
     // Write scene log
     log.write(scene, camera, image);    
 }
-        
\ No newline at end of file
@@ -6,18 +6,19 @@
 #include "pdf.hpp"
 #include "utilities.hpp"
 #include "ray.hpp"
+#include "arena.hpp"
 
-bool Material::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const
+bool Material::scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const
 {
     return false;
 }
 
-color Material::emitted(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec) const
+color Material::emitted(const Ray& incoming_ray, const hit_record& rec) const
 {
     return color(0, 0, 0);
 }
 
-double Material::scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const
+double Material::scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const
 {
     return 0;
 }
@@ -37,43 +38,42 @@ Lambertian::Lambertian(shared_ptr<Texture> texture) : texture(texture)
     type = LAMBERTIAN; 
 }
 
-bool Lambertian::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const
+bool Lambertian::scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const
 {
-    // auto scatter_direction = rec->normal + random_unit_vector();
+    // auto scatter_direction = rec.normal + random_unit_vector();
     srec.is_specular = false;
-    srec.specular_ray = nullptr;
-    srec.pdf = make_shared<cosine_hemisphere_pdf>(rec->normal);
-    srec.attenuation = texture->value(rec->texture_coordinates, rec->p);
+    srec.pdf = MemoryArena::local().create<cosine_hemisphere_pdf>(rec.normal);
+    srec.attenuation = texture->value(rec.texture_coordinates, rec.p);
     srec.scatter_type = REFLECT;
     return true;
 }
 
-double Lambertian::scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const
+double Lambertian::scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const
 {
-    auto cos_theta = dot(rec->normal, unit_vector(scattered_ray->direction()));
+    auto cos_theta = dot(rec.normal, unit_vector(scattered_ray.direction()));
     return cos_theta < 0 ? 0 : cos_theta / pi;
 }
 
 Metal::Metal(const color& albedo, double fuzz) : albedo(albedo), fuzz(fuzz < 1 ? fuzz : 1) { type = METAL; }
 
-bool Metal::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const
+bool Metal::scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const
 {
     // Reflect the incoming ray
-    vec3 reflected = reflect(incoming_ray->direction(), rec->normal);
-    reflected = unit_vector(reflected) + (fuzz * random_unit_vector());
+    vec3 reflected = reflect(incoming_ray.direction(), rec.normal);
+    reflected = unit_vector(reflected) + (fuzz * random_unit_vector(sampler));
 
     // Create reflected ray
-    auto reflected_ray = Ray(rec->p, reflected, incoming_ray->time());
+    auto reflected_ray = Ray(rec.p, reflected, incoming_ray.time());
 
     // Save data into scatter record
     srec.is_specular = true;
-    srec.specular_ray = make_shared<Ray>(reflected_ray);
+    srec.specular_ray = reflected_ray;
     srec.pdf = nullptr;
     srec.attenuation = albedo;
     srec.scatter_type = REFLECT;
 
     // Absorb the ray if it's reflected into the surface
-    // return dot(reflected_ray.direction(), rec->normal) > 0;
+    // return dot(reflected_ray.direction(), rec.normal) > 0;
 
     return true;
 }
@@ -83,17 +83,17 @@ Dielectric::Dielectric(double refraction_index) : refraction_index(refraction_in
     type = DIELECTRIC; 
 }
 
-bool Dielectric::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const
+bool Dielectric::scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const
 {
     // Attenuation is always 1 (the glass surface absorbs nothing)
     auto attenuation = color(1.0, 1.0, 1.0);
 
     // Check refractive index order
-    double ri = rec->front_face ? (1.0 / refraction_index) : refraction_index;
+    double ri = rec.front_face ? (1.0 / refraction_index) : refraction_index;
 
     // Calculate cosinus and sinus of theta (angle between the ray and the normal)
-    vec3 unit_direction = unit_vector(incoming_ray->direction());
-    double cos_theta = std::fmin(dot(-unit_direction, rec->normal), 1.0);
+    vec3 unit_direction = unit_vector(incoming_ray.direction());
+    double cos_theta = std::fmin(dot(-unit_direction, rec.normal), 1.0);
     double sin_theta = std::sqrt(1.0 - cos_theta * cos_theta);
 
     // Check if there is total reflection (the ray cannot refract)
@@ -104,23 +104,23 @@ bool Dielectric::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<h
 
     // Check if the ray should reflect or refract
     vec3 scattering_direction;
-    if (cannot_refract || reflect_prob > random_double())
+    if (cannot_refract || reflect_prob > sampler.random_double())
     {
-        scattering_direction = reflect(unit_direction, rec->normal);
+        scattering_direction = reflect(unit_direction, rec.normal);
         srec.scatter_type = REFLECT;
     }
     else
     {
-        scattering_direction = refract(unit_direction, rec->normal, cos_theta, ri);
+        scattering_direction = refract(unit_direction, rec.normal, cos_theta, ri);
         srec.scatter_type = REFRACT;
     }
 
     // Create scattered ray
-    auto scattered_ray = Ray(rec->p, scattering_direction, incoming_ray->time());
+    auto scattered_ray = Ray(rec.p, scattering_direction, incoming_ray.time());
 
     // Save data into scatter record
     srec.is_specular = true;
-    srec.specular_ray = make_shared<Ray>(scattered_ray);
+    srec.specular_ray = scattered_ray;
     srec.pdf = nullptr;
     srec.attenuation = attenuation;
 
@@ -145,12 +145,12 @@ DiffuseLight::DiffuseLight(const color& emit) : texture(make_shared<SolidColor>(
     type = DIFFUSE_LIGHT; 
 }
 
-color DiffuseLight::emitted(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec) const
+color DiffuseLight::emitted(const Ray& incoming_ray, const hit_record& rec) const
 {
-    if (!rec->front_face)
+    if (!rec.front_face)
         return color(0, 0, 0);
 
-    return texture->value(rec->texture_coordinates, rec->p);
+    return texture->value(rec.texture_coordinates, rec.p);
 }
 
 Isotropic::Isotropic(const color& albedo) : texture(make_shared<SolidColor>(albedo)) 
@@ -163,17 +163,16 @@ Isotropic::Isotropic(shared_ptr<Texture> texture) : texture(texture)
     type = ISOTROPIC; 
 }
 
-bool Isotropic::scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const
+bool Isotropic::scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const
 {
     srec.is_specular = false;
-    srec.specular_ray = nullptr;
-    srec.pdf = make_shared<uniform_sphere_pdf>();
-    srec.attenuation = texture->value(rec->texture_coordinates, rec->p);
+    srec.pdf = MemoryArena::local().create<uniform_sphere_pdf>();
+    srec.attenuation = texture->value(rec.texture_coordinates, rec.p);
     srec.scatter_type = REFLECT;
     return true;
 }
 
-double Isotropic::scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const
+double Isotropic::scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const
 {
     return 1 / (4 * pi);
 }
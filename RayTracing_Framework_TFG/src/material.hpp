@@ -3,12 +3,13 @@
 // Headers
 #include "core.hpp"
 #include "vec3.hpp"
+#include "ray.hpp"
 
 // Forward declarations
-class Ray;
 class PDF;
 class hit_record;
 class Texture;
+class Sampler;
 
 enum SCATTER_TYPE
 {
@@ -30,8 +31,8 @@ struct scatter_record
 {
 public:
 	bool is_specular;
-	shared_ptr<Ray> specular_ray;
-	shared_ptr<PDF> pdf;
+	Ray specular_ray;
+	const PDF* pdf;     // Allocated in the thread's MemoryArena (nullptr for specular scattering)
 	color attenuation;
     SCATTER_TYPE scatter_type;
 };
@@ -41,9 +42,9 @@ class Material
 public:
     virtual ~Material() = default;
 
-    virtual bool scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const;
-    virtual color emitted(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec) const;
-    virtual double scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const;
+    virtual bool scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const;
+    virtual color emitted(const Ray& incoming_ray, const hit_record& rec) const;
+    virtual double scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const;
     const MATERIAL_TYPE get_type() const;
 
 protected:
@@ -56,8 +57,8 @@ public:
     Lambertian(const color& albedo);
     Lambertian(shared_ptr<Texture> texture);
 
-    bool scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const override;
-    double scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const override;
+    bool scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const override;
+    double scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const override;
 
 private:
     shared_ptr<Texture> texture;
@@ -68,7 +69,7 @@ class Metal : public Material
 public:
     Metal(const color& albedo, double fuzz);
 
-    bool scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const override;
+    bool scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const override;
 
 private:
     color albedo;
@@ -80,7 +81,7 @@ class Dielectric : public Material
 public:
     Dielectric(double refraction_index);
 
-    bool scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const override;
+    bool scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const override;
 
 private:
     double refraction_index; // Refractive index in vacuum or air, or the ratio of the material's refractive index over the refractive index of the enclosing media
@@ -94,7 +95,7 @@ public:
     DiffuseLight(shared_ptr<Texture> texture);
     DiffuseLight(const color& emit);
 
-    color emitted(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec) const override;
+    color emitted(const Ray& incoming_ray, const hit_record& rec) const override;
 
 private:
     shared_ptr<Texture> texture;
@@ -106,8 +107,8 @@ public:
     Isotropic(const color& albedo);
     Isotropic(shared_ptr<Texture> texture);
 
-    bool scatter(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, scatter_record& srec) const override;
-    double scattering_pdf_value(const shared_ptr<Ray>& incoming_ray, const shared_ptr<hit_record>& rec, const shared_ptr<Ray>& scattered_ray) const override;
+    bool scatter(const Ray& incoming_ray, const hit_record& rec, scatter_record& srec, Sampler& sampler) const override;
+    double scattering_pdf_value(const Ray& incoming_ray, const hit_record& rec, const Ray& scattered_ray) const override;
 
 private:
     shared_ptr<Texture> texture;
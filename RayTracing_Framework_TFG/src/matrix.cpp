@@ -22,9 +22,7 @@ Matrix::Matrix(unsigned num_rows, unsigned num_columns, double initial)
     values = vector<vector<double>>(num_rows, vector<double>(num_columns, initial));
 }
 
-Matrix44::Matrix44(double initial) : Matrix(4, 4, initial) {}
-
-Matrix44::Matrix44(const Matrix& matrix) : Matrix(matrix)
+Matrix44::Matrix44(const Matrix& matrix)
 {
     int num_rows = matrix.get_num_rows();
     int num_columns = matrix.get_num_columns();
@@ -34,21 +32,14 @@ Matrix44::Matrix44(const Matrix& matrix) : Matrix(matrix)
         string error = Logger::error("Matrix", std::format("Invalid cast exception! You are trying to convert a Matrix into a Matrix44 but Matrix is {}x{} and not 4x4", num_rows, num_columns));
         throw std::invalid_argument(error);
     }
-}
 
-Matrix44::Matrix44
-(
-    double m00, double m01, double m02, double m03,
-    double m10, double m11, double m12, double m13,
-    double m20, double m21, double m22, double m23,
-    double m30, double m31, double m32, double m33
-) 
-    : Matrix(4, 4)
-{
-    (*this)[0][0] = m00; (*this)[0][1] = m01; (*this)[0][2] = m02; (*this)[0][3] = m03;
-    (*this)[1][0] = m10; (*this)[1][1] = m11; (*this)[1][2] = m12; (*this)[1][3] = m13;
-    (*this)[2][0] = m20; (*this)[2][1] = m21; (*this)[2][2] = m22; (*this)[2][3] = m23;
-    (*this)[3][0] = m30; (*this)[3][1] = m31; (*this)[3][2] = m32; (*this)[3][3] = m33;
+    for (unsigned i = 0; i < 4; i++)
+    {
+        for (unsigned j = 0; j < 4; j++)
+        {
+            (*this)[i][j] = matrix[i][j];
+        }
+    }
 }
 
 Matrix33::Matrix33(double initial) : Matrix(3, 3, initial) {}
@@ -211,6 +202,111 @@ Matrix Matrix::inverse() const
     return adjugate;
 }
 
+Matrix44 Matrix44::inverse() const
+{
+    const Matrix44& m = *this;
+
+    // 2x2 minors of the two upper and the two lower rows
+    double s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    double s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    double s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    double s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    double s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    double s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+    double c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    double c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    double c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    double c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    double c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    double c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    double det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0)
+    {
+        string error = Logger::error("MATRIX", "Matrix is singular and cannot be inverted.");
+        throw std::invalid_argument(error);
+    }
+
+    double inv_det = 1.0 / det;
+
+    return Matrix44
+    (
+        ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_det,
+        (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv_det,
+        ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_det,
+        (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv_det,
+
+        (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv_det,
+        ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_det,
+        (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv_det,
+        ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_det,
+
+        ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_det,
+        (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv_det,
+        ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_det,
+        (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv_det,
+
+        (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv_det,
+        ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_det,
+        (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv_det,
+        ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_det
+    );
+}
+
+Matrix44 Matrix44::affine_inverse() const
+{
+    const Matrix44& m = *this;
+
+    // Cofactors of the upper 3x3 block
+    double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+
+    double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+    if (det == 0)
+    {
+        string error = Logger::error("MATRIX", "Matrix is singular and cannot be inverted.");
+        throw std::invalid_argument(error);
+    }
+
+    double inv_det = 1.0 / det;
+
+    // Inverse of the 3x3 block (transposed cofactors over the determinant)
+    double i00 = c00 * inv_det;
+    double i10 = c01 * inv_det;
+    double i20 = c02 * inv_det;
+    double i01 = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv_det;
+    double i11 = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv_det;
+    double i21 = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv_det;
+    double i02 = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv_det;
+    double i12 = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv_det;
+    double i22 = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv_det;
+
+    // The inverse translation is the original one brought back through the inverse block
+    double tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+    return Matrix44
+    (
+        i00, i01, i02, -(i00 * tx + i01 * ty + i02 * tz),
+        i10, i11, i12, -(i10 * tx + i11 * ty + i12 * tz),
+        i20, i21, i22, -(i20 * tx + i21 * ty + i22 * tz),
+        0.0, 0.0, 0.0, 1.0
+    );
+}
+
+Matrix44 Matrix44::normal_matrix() const
+{
+    // The translation column of the affine inverse is dropped, since normals are directions
+    Matrix44 inverse_transpose = affine_inverse().transpose();
+
+    inverse_transpose[3][0] = 0.0;
+    inverse_transpose[3][1] = 0.0;
+    inverse_transpose[3][2] = 0.0;
+
+    return inverse_transpose;
+}
+
 double Matrix::trace() const
 {
     if (num_rows != num_columns)
@@ -448,6 +544,11 @@ std::ostream& operator<<(std::ostream& out, const Matrix& m)
     return out;
 }
 
+std::ostream& operator<<(std::ostream& out, const Matrix44& m)
+{
+    return out << m.to_matrix();
+}
+
 // Help methods
 void Matrix::print() const
 {
@@ -485,4 +586,18 @@ unsigned Matrix::get_num_rows() const
 unsigned Matrix::get_num_columns() const
 {
     return num_columns;
+}
+
+Matrix Matrix44::to_matrix() const
+{
+    Matrix result(4, 4);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        for (unsigned j = 0; j < 4; j++)
+        {
+            result[i][j] = (*this)[i][j];
+        }
+    }
+    return result;
 }
\ No newline at end of file
@@ -56,18 +56,44 @@ private:
     Matrix();
 };
 
-class Matrix44 : public Matrix
+class alignas(32) Matrix44 // Fixed-size 4x4 matrix stored inline in row-major order, so affine transforms need no heap storage
 {
 public:
-    Matrix44(double initial = 0.0);
+    // Constructors
+    constexpr Matrix44(double initial = 0.0);
     Matrix44(const Matrix& m); // Conversion constructor
-    Matrix44
+    constexpr Matrix44
     (
         double m00, double m01, double m02, double m03,
         double m10, double m11, double m12, double m13,
         double m20, double m21, double m22, double m23,
         double m30, double m31, double m32, double m33
     );
+
+    // Matrix Operations
+    static constexpr Matrix44 identity();
+    constexpr Matrix44 transpose() const;
+    constexpr double determinant() const;
+    Matrix44 inverse() const;           // Closed-form inverse of a general 4x4 matrix
+    Matrix44 affine_inverse() const;    // Closed-form inverse of an affine matrix (bottom row 0 0 0 1)
+    Matrix44 normal_matrix() const;     // Inverse transpose of the upper 3x3 block, which keeps normals perpendicular under non-uniform scaling
+    constexpr bool is_affine() const;
+
+    // Affine transformations
+    constexpr vec3 transform_point(const point3& p) const;   // Applies rotation, scaling and translation (w = 1)
+    constexpr vec3 transform_vector(const vec3& v) const;    // Applies rotation and scaling only (w = 0)
+
+    // Operator Overloads
+    constexpr double* operator[](unsigned row);
+    constexpr const double* operator[](unsigned row) const;
+    constexpr double operator()(unsigned row, unsigned col) const;
+    friend std::ostream& operator<<(std::ostream& out, const Matrix44& m);
+
+    // Conversion
+    Matrix to_matrix() const;
+
+private:
+    std::array<double, 16> values;
 };
 
 class Matrix33 : public Matrix
@@ -276,16 +302,136 @@ inline Matrix operator+(double scalar, const Matrix& M) { return M + scalar; }
 inline Matrix operator-(double scalar, const Matrix& M) { return (-M) + scalar; }
 inline Matrix operator*(double scalar, const Matrix& M) { return M * scalar; }
 
-// Matrix44 & vec4 operators
-inline vec4 operator*(const Matrix44& mat, const vec4& v) 
+// ************ Matrix44 inline members ************ //
+
+constexpr Matrix44::Matrix44(double initial) : values{}
+{
+    values.fill(initial);
+}
+
+constexpr Matrix44::Matrix44
+(
+    double m00, double m01, double m02, double m03,
+    double m10, double m11, double m12, double m13,
+    double m20, double m21, double m22, double m23,
+    double m30, double m31, double m32, double m33
+)
+    : values{ m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33 } {}
+
+constexpr Matrix44 Matrix44::identity()
+{
+    return Matrix44
+    (
+        1.0, 0.0, 0.0, 0.0,
+        0.0, 1.0, 0.0, 0.0,
+        0.0, 0.0, 1.0, 0.0,
+        0.0, 0.0, 0.0, 1.0
+    );
+}
+
+constexpr Matrix44 Matrix44::transpose() const
+{
+    const Matrix44& m = *this;
+
+    return Matrix44
+    (
+        m[0][0], m[1][0], m[2][0], m[3][0],
+        m[0][1], m[1][1], m[2][1], m[3][1],
+        m[0][2], m[1][2], m[2][2], m[3][2],
+        m[0][3], m[1][3], m[2][3], m[3][3]
+    );
+}
+
+constexpr double Matrix44::determinant() const
+{
+    const Matrix44& m = *this;
+
+    // 2x2 minors of the two lower rows, shared by the cofactor expansion along the first row
+    double s0 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+    double s1 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+    double s2 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+    double s3 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+    double s4 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+    double s5 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+
+    return m[0][0] * (m[1][1] * s0 - m[1][2] * s1 + m[1][3] * s2)
+         - m[0][1] * (m[1][0] * s0 - m[1][2] * s3 + m[1][3] * s4)
+         + m[0][2] * (m[1][0] * s1 - m[1][1] * s3 + m[1][3] * s5)
+         - m[0][3] * (m[1][0] * s2 - m[1][1] * s4 + m[1][2] * s5);
+}
+
+constexpr bool Matrix44::is_affine() const
+{
+    return values[12] == 0.0 && values[13] == 0.0 && values[14] == 0.0 && values[15] == 1.0;
+}
+
+constexpr vec3 Matrix44::transform_point(const point3& p) const
 {
-    vec4 result;
+    const Matrix44& m = *this;
 
-    for (int i = 0; i < 4; ++i) 
+    return vec3
+    (
+        m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+        m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+        m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]
+    );
+}
+
+constexpr vec3 Matrix44::transform_vector(const vec3& v) const
+{
+    const Matrix44& m = *this;
+
+    return vec3
+    (
+        m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+        m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+        m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z
+    );
+}
+
+constexpr double* Matrix44::operator[](unsigned row)
+{
+    return values.data() + 4 * row;
+}
+
+constexpr const double* Matrix44::operator[](unsigned row) const
+{
+    return values.data() + 4 * row;
+}
+
+constexpr double Matrix44::operator()(unsigned row, unsigned col) const
+{
+    return values[4 * row + col];
+}
+
+// Matrix44 operators
+constexpr Matrix44 operator*(const Matrix44& A, const Matrix44& B)
+{
+    Matrix44 result;
+
+    // Each result row is a linear combination of the rows of B, which keeps the inner loop contiguous and vectorizable
+    for (unsigned i = 0; i < 4; i++)
     {
-        result[i] = mat[i][0] * v.x + mat[i][1] * v.y + mat[i][2] * v.z + mat[i][3] * v.w;
+        for (unsigned k = 0; k < 4; k++)
+        {
+            double a = A[i][k];
+
+            for (unsigned j = 0; j < 4; j++)
+                result[i][j] += a * B[k][j];
+        }
     }
 
     return result;
 }
 
+// Matrix44 & vec4 operators
+constexpr vec4 operator*(const Matrix44& mat, const vec4& v)
+{
+    return vec4
+    (
+        mat[0][0] * v.x + mat[0][1] * v.y + mat[0][2] * v.z + mat[0][3] * v.w,
+        mat[1][0] * v.x + mat[1][1] * v.y + mat[1][2] * v.z + mat[1][3] * v.w,
+        mat[2][0] * v.x + mat[2][1] * v.y + mat[2][2] * v.z + mat[2][3] * v.w,
+        mat[3][0] * v.x + mat[3][1] * v.y + mat[3][2] * v.z + mat[3][3] * v.w
+    );
+}
@@ -0,0 +1,82 @@
+﻿// Headers
+#include "core.hpp"
+#include "memory_stats.hpp"
+#include "scene.hpp"
+#include "mesh.hpp"
+#include "sphere.hpp"
+#include "quad.hpp"
+#include "triangle.hpp"
+#include "bvh.hpp"
+#include "linear_bvh.hpp"
+#include "aabb.hpp"
+#include "image_writer.hpp"
+#include "image_reader.hpp"
+#include "framebuffer.hpp"
+#include "arena.hpp"
+#include "system_info.hpp"
+
+uint64_t MemoryStats::primitives() const
+{
+    return spheres + quads + triangles;
+}
+
+uint64_t MemoryStats::total() const
+{
+    return primitives() + bvh_nodes + mesh_vertices + mesh_indices + textures + framebuffer + image_buffer + render_arenas;
+}
+
+MemoryStats MemoryStats::collect(const Scene& scene, const ImageWriter& image)
+{
+    MemoryStats stats;
+
+    // Meshes
+    uint64_t mesh_triangles = 0;
+    uint64_t mesh_bvh_nodes = 0;
+    uint64_t wide_bvh_boxes = 0;
+
+    for (const auto& mesh : scene.meshes)
+    {
+        const TriangleMesh& geometry = mesh->get_geometry();
+
+        mesh_triangles += geometry.num_triangles();
+        mesh_bvh_nodes += geometry.bvh_nodes();
+        wide_bvh_boxes += geometry.wide_bvh().num_nodes() * geometry.wide_bvh().width();
+        stats.mesh_vertices += geometry.vertex_bytes();
+        stats.mesh_indices += geometry.index_bytes();
+        stats.bvh_nodes += geometry.bvh_bytes();
+    }
+
+    // Primitives by type
+    uint64_t standalone_triangles = uint64_t(scene.triangles) - mesh_triangles;
+
+    stats.spheres = uint64_t(scene.spheres) * sizeof(Sphere);
+    stats.quads = uint64_t(scene.quads) * sizeof(Quad);
+    stats.triangles = standalone_triangles * sizeof(Triangle);
+
+    // Scene BVH, plus its flattened copy
+    stats.bvh_nodes += uint64_t(scene.bvh_nodes) * sizeof(bvh_node);
+    uint64_t linear_bvh_nodes = 0;
+
+    if (scene.linear_bvh)
+    {
+        stats.bvh_nodes += scene.linear_bvh->memory_bytes();
+        linear_bvh_nodes = scene.linear_bvh->num_nodes();
+        wide_bvh_boxes += scene.linear_bvh->wide().num_nodes() * scene.linear_bvh->wide().width();
+    }
+
+    // Every standalone primitive and every pointer tree node keeps its own box, while the flat nodes and the child slots of the wide nodes keep single precision bounds
+    uint64_t boxes = uint64_t(scene.spheres) + scene.quads + standalone_triangles + scene.bvh_nodes;
+    uint64_t flat_boxes = mesh_bvh_nodes + linear_bvh_nodes + wide_bvh_boxes;
+    stats.bounding_boxes = boxes * sizeof(AABB) + flat_boxes * sizeof(linear_bvh_node::bounds_min) * 2;
+
+    // Images
+    stats.textures = ImageReader::loaded_bytes();
+    stats.framebuffer = image.framebuffer ? image.framebuffer->memory_bytes() : 0;
+    stats.image_buffer = image.buffer_bytes();
+
+    // Rendering
+    stats.render_arenas = MemoryArena::peak_reserved_bytes();
+    stats.peak_resident = SystemInfo::peak_resident_memory();
+
+    return stats;
+}
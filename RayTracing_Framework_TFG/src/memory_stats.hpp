@@ -0,0 +1,39 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+// Forward declarations
+class Scene;
+class ImageWriter;
+
+struct MemoryStats // Byte footprint of the scene and render subsystems, gathered after rendering for the render log
+{
+public:
+    // Primitives by type (object sizes, the triangles of meshes live in the mesh buffers)
+    uint64_t spheres = 0;
+    uint64_t quads = 0;
+    uint64_t triangles = 0;
+
+    // Acceleration structures
+    uint64_t bvh_nodes = 0;             // Scene BVH nodes, its flattened copy and the mesh BVH nodes
+    uint64_t bounding_boxes = 0;        // Boxes held by value inside the primitives and BVH nodes, already part of the figures above
+
+    // Meshes
+    uint64_t mesh_vertices = 0;         // Shared vertex attribute buffers
+    uint64_t mesh_indices = 0;          // Index buffers and per-triangle material ids
+
+    // Images
+    uint64_t textures = 0;              // Float and byte pixel buffers of the image textures
+    uint64_t framebuffer = 0;           // Float accumulation buffers
+    uint64_t image_buffer = 0;          // 8-bit output image
+
+    // Rendering
+    uint64_t render_arenas = 0;         // Peak bytes reserved by the per-thread memory arenas for transient sampling objects
+    uint64_t peak_resident = 0;         // Peak resident memory of the whole process
+
+    uint64_t primitives() const;
+    uint64_t total() const;             // Sum of the accounted subsystems, without the bounding boxes counted twice
+
+    static MemoryStats collect(const Scene& scene, const ImageWriter& image);
+};
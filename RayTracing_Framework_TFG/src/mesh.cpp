@@ -1,39 +1,32 @@
 ﻿// Headers
 #include "core.hpp"
 #include "mesh.hpp"
-#include "hittable_list.hpp"
-#include "bvh.hpp"
-#include "surface.hpp"
 #include "interval.hpp"
 #include "chrono.hpp"
 #include "aabb.hpp"
 
-Mesh::Mesh(const string& name, const shared_ptr<hittable_list>& surfaces, const vector<string>& material_names, const vector<string>& texture_names)
-	: _name(name), _material_names(material_names), _texture_names(texture_names)
+Mesh::Mesh(const string& name, TriangleMesh&& geometry, int num_surfaces, const vector<string>& material_names, const vector<string>& texture_names, const BVHSettings& bvh_settings)
+	: _name(name), _num_surfaces(num_surfaces), _material_names(material_names), _texture_names(texture_names), geometry(std::move(geometry))
 {
 	type = MESH;
 
-	_num_surfaces = int(surfaces->size());
-	this->surfaces = make_shared<bvh_node>(*surfaces);
-	bbox = this->surfaces->bounding_box();
-	mesh_bvh_chrono = this->surfaces->bvh_chrono();
+	_num_triangles = int(this->geometry.num_triangles());
+	_num_vertices = int(this->geometry.num_vertices());
 
-	for (auto object : surfaces->objects)
-	{
-		auto surface = std::dynamic_pointer_cast<Surface>(object);
-		_num_triangles += surface->num_triangles();
-		*mesh_bvh_chrono += *surface->bvh_chrono();
-	}
+	mesh_bvh_chrono = make_shared<Chrono>();
+	mesh_bvh_chrono->start();
+	this->geometry.build_bvh(bvh_settings);
+	mesh_bvh_chrono->end();
 }
 
-bool Mesh::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool Mesh::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-	return surfaces->hit(r, ray_t, rec);
+	return geometry.hit(r, ray_t, rec);
 }
 
-shared_ptr<AABB> Mesh::bounding_box() const
+const AABB& Mesh::bounding_box() const
 { 
-	return bbox; 
+	return geometry.bounding_box(); 
 }
 
 const shared_ptr<Chrono> Mesh::bvh_chrono() const
@@ -51,6 +44,11 @@ const int& Mesh::num_triangles() const
 	return _num_triangles; 
 }
 
+const int& Mesh::num_vertices() const
+{ 
+	return _num_vertices; 
+}
+
 const int& Mesh::num_surfaces() const
 { 
 	return _num_surfaces; 
@@ -66,3 +64,8 @@ const vector<string>& Mesh::texture_names()
 	return _texture_names; 
 }
 
+const TriangleMesh& Mesh::get_geometry() const
+{ 
+	return geometry; 
+}
+
@@ -2,36 +2,37 @@
 
 // Headers
 #include "hittable.hpp"
+#include "triangle_mesh.hpp"
 
 // Forward declarations
-class hittable_list;
 struct Chrono;
-class bvh_node;
 
 class Mesh : public Hittable
 {
 public:
-	Mesh(const string& name, const shared_ptr<hittable_list>& surfaces, const vector<string>& material_names, const vector<string>& texture_names);
+	Mesh(const string& name, TriangleMesh&& geometry, int num_surfaces, const vector<string>& material_names, const vector<string>& texture_names, const BVHSettings& bvh_settings = BVHSettings());
 
-	bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
-	shared_ptr<AABB> bounding_box() const override;
+	bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+	const AABB& bounding_box() const override;
 	const shared_ptr<Chrono> bvh_chrono() const;
 	const string& name() const;
 	const int& num_triangles() const;
+	const int& num_vertices() const;
 	const int& num_surfaces() const;
 	const vector<string>& material_names();
 	const vector<string>& texture_names();
+	const TriangleMesh& get_geometry() const;
 
 
 private:
 	string _name = "error.obj";
 	int _num_triangles = 0;
+	int _num_vertices = 0;
 	int _num_surfaces = 0;
 	vector<string> _material_names;
 	vector<string> _texture_names;
-	shared_ptr<bvh_node> surfaces;
+	TriangleMesh geometry;
 	shared_ptr<Chrono> mesh_bvh_chrono;
-	shared_ptr<AABB> bbox;
 };
 
 
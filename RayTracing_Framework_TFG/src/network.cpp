@@ -0,0 +1,216 @@
+﻿// Headers
+#include "core.hpp"
+#include "network.hpp"
+
+// Platform Headers
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+using socket_length = int;
+#define close_socket closesocket
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+using socket_length = socklen_t;
+#define close_socket ::close
+#endif
+
+Socket::Socket() {}
+
+Socket::Socket(intptr_t handle) : handle(handle) {}
+
+Socket::~Socket()
+{
+    close();
+}
+
+Socket::Socket(Socket&& other) noexcept : handle(other.handle)
+{
+    other.handle = -1;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        handle = other.handle;
+        other.handle = -1;
+    }
+
+    return *this;
+}
+
+bool Socket::startup()
+{
+#ifdef _WIN32
+    static bool started = false;
+    static std::mutex startup_mutex;
+    std::lock_guard<std::mutex> lock(startup_mutex);
+
+    if (!started)
+    {
+        WSADATA wsa_data;
+        started = WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0;
+    }
+
+    return started;
+#else
+    return true;
+#endif
+}
+
+bool Socket::connect(const string& host, int port)
+{
+    close();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+        return false;
+
+    for (addrinfo* address = addresses; address; address = address->ai_next)
+    {
+        auto s = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (intptr_t(s) < 0)
+            continue;
+
+        if (::connect(s, address->ai_addr, socket_length(address->ai_addrlen)) == 0)
+        {
+            handle = intptr_t(s);
+            break;
+        }
+
+        close_socket(s);
+    }
+
+    freeaddrinfo(addresses);
+
+    if (!valid())
+        return false;
+
+    // Tile results are written in one go, so there is nothing to gain from Nagle's algorithm
+    int flag = 1;
+    setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag));
+    setsockopt(handle, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&flag), sizeof(flag));
+
+    return true;
+}
+
+bool Socket::listen(int port)
+{
+    close();
+
+    auto s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (intptr_t(s) < 0)
+        return false;
+
+    int flag = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&flag), sizeof(flag));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(uint16_t(port));
+
+    if (::bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(s, SOMAXCONN) != 0)
+    {
+        close_socket(s);
+        return false;
+    }
+
+    handle = intptr_t(s);
+    return true;
+}
+
+Socket Socket::accept()
+{
+    auto s = ::accept(handle, nullptr, nullptr);
+    if (intptr_t(s) < 0)
+        return Socket();
+
+    int flag = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag));
+    setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&flag), sizeof(flag));
+
+    return Socket(intptr_t(s));
+}
+
+bool Socket::wait_readable(int milliseconds) const
+{
+    if (!valid())
+        return false;
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(handle, &readable);
+
+    timeval timeout;
+    timeout.tv_sec = milliseconds / 1000;
+    timeout.tv_usec = (milliseconds % 1000) * 1000;
+
+    return select(int(handle + 1), &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+bool Socket::send_all(const void* data, size_t size)
+{
+    auto bytes = static_cast<const char*>(data);
+
+    while (size > 0)
+    {
+        int chunk = int(std::min<size_t>(size, 1 << 20));
+#ifdef _WIN32
+        int sent = ::send(handle, bytes, chunk, 0);
+#else
+        int sent = int(::send(handle, bytes, chunk, MSG_NOSIGNAL));
+#endif
+        if (sent <= 0)
+            return false;
+
+        bytes += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+bool Socket::receive_all(void* data, size_t size)
+{
+    auto bytes = static_cast<char*>(data);
+
+    while (size > 0)
+    {
+        int chunk = int(std::min<size_t>(size, 1 << 20));
+        int received = int(::recv(handle, bytes, chunk, 0));
+        if (received <= 0)
+            return false;
+
+        bytes += received;
+        size -= received;
+    }
+
+    return true;
+}
+
+bool Socket::valid() const
+{
+    return handle >= 0;
+}
+
+void Socket::close()
+{
+    if (valid())
+    {
+        close_socket(handle);
+        handle = -1;
+    }
+}
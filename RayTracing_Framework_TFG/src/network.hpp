@@ -0,0 +1,32 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+class Socket // Blocking TCP socket over Winsock or BSD sockets
+{
+public:
+    Socket();
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+
+    bool connect(const string& host, int port);
+    bool listen(int port);
+    Socket accept();
+    bool wait_readable(int milliseconds) const;         // Whether a read (or an accept) would not block within the timeout
+    bool send_all(const void* data, size_t size);
+    bool receive_all(void* data, size_t size);          // False if the peer closed the connection or an error occurred
+    bool valid() const;
+    void close();
+
+    static bool startup();                              // Initializes the socket library once per process
+
+private:
+    intptr_t handle = -1;
+
+    explicit Socket(intptr_t handle);
+};
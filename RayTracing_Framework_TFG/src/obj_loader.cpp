@@ -3,11 +3,9 @@
 #include "obj_loader.hpp"
 #include "logger.hpp"
 #include "mesh.hpp"
-#include "surface.hpp"
-#include "triangle.hpp"
+#include "triangle_mesh.hpp"
 #include "material.hpp"
 #include "texture.hpp"
-#include "hittable_list.hpp"
 #include "vec3.hpp"
 
 // Macros
@@ -16,7 +14,7 @@
 // External Headers
 #include "../external/tiny_obj_loader.hpp"
 
-shared_ptr<Mesh> load_obj(const string& filename)
+shared_ptr<Mesh> load_obj(const string& filename, const BVHSettings& bvh_settings)
 {
     // Create tiny obj reader object
     tinyobj::ObjReaderConfig reader_config;
@@ -45,43 +43,122 @@ shared_ptr<Mesh> load_obj(const string& filename)
     auto& materials = reader.GetMaterials(); // Materials included in the obj
 
     // Mesh vars
-    shared_ptr<hittable_list> surfaces = make_shared<hittable_list>();
+    TriangleMesh geometry;
     vector<string> texture_names;
     vector<string> material_names;
 
-    // Loop over shapes (surfaces)
-    for (size_t s = 0; s < shapes.size(); s++)
+    // Create one material per obj material, shared by every face that references it
+    for (const auto& obj_material : materials)
     {
-        // Create new shape
-        shared_ptr<Surface> surface;
-        shared_ptr<Material> material;
-        shared_ptr<hittable_list> triangles = make_shared<hittable_list>();
+        // If there is no diffuse texture, create one
+        if (obj_material.diffuse_texname.empty())
+        {
+            const color albedo = color(static_cast<double>(obj_material.diffuse[0]),
+                static_cast<double>(obj_material.diffuse[1]),
+                static_cast<double>(obj_material.diffuse[2]));
 
-        if (!materials.empty())
+            geometry.materials.push_back(make_shared<Lambertian>(albedo));
+        }
+        // Else, load diffuse texture
+        else
         {
-            // Get shape material id
-            uint32_t material_id = shapes[s].mesh.material_ids[0];
-            material_id = material_id == -1 ? 0 : material_id;
+            auto texture_name = obj_material.diffuse_texname;
+            auto texture = make_shared<ImageTexture>(obj_path_fs.parent_path().string() + "/" + texture_name);
+            geometry.materials.push_back(make_shared<Lambertian>(texture));
+            texture_names.push_back(texture_name);
+        }
 
-            // If there is no diffuse texture, create one
-            if (materials[material_id].diffuse_texname.empty())
-            {
-                const color albedo = color(static_cast<double>(materials[material_id].diffuse[0]),
-                    static_cast<double>(materials[material_id].diffuse[1]),
-                    static_cast<double>(materials[material_id].diffuse[2]));
+        material_names.push_back(obj_material.name);
+    }
+
+    // Faces without a usable material fall back to a neutral grey
+    if (geometry.materials.empty())
+    {
+        Logger::warn("TinyObjReader", "The obj file has no materials, a grey lambertian material is used instead.");
+        geometry.materials.push_back(make_shared<Lambertian>(color(0.5, 0.5, 0.5)));
+    }
+
+    if (geometry.materials.size() > std::numeric_limits<uint16_t>::max())
+    {
+        Logger::error("TinyObjReader", "The obj file has more materials than the mesh material ids can address.");
+        return nullptr;
+    }
+
+    // Obj faces index positions, normals and texture coordinates separately.
+    // Corners that share all three indices become a single mesh vertex. The mesh vertices created for each
+    // position are chained from first_vertex through next_vertex, so the lookup needs no hash map.
+    constexpr uint32_t no_vertex = std::numeric_limits<uint32_t>::max();
+    vector<uint32_t> first_vertex(attrib.vertices.size() / 3, no_vertex);
+    vector<uint32_t> next_vertex;
+    vector<tinyobj::index_t> vertex_keys;
+
+    bool has_normals = !attrib.normals.empty();
+    bool has_uvs = !attrib.texcoords.empty();
+
+    // tinyobj fills missing vertex colors with white, so the color buffer is only kept when some color differs
+    bool has_colors = std::any_of(attrib.colors.begin(), attrib.colors.end(), [](tinyobj::real_t c) { return c != 1; });
+
+    auto find_or_add_vertex = [&](const tinyobj::index_t& idx) -> uint32_t
+    {
+        for (uint32_t vertex = first_vertex[idx.vertex_index]; vertex != no_vertex; vertex = next_vertex[vertex])
+        {
+            if (vertex_keys[vertex].normal_index == idx.normal_index && vertex_keys[vertex].texcoord_index == idx.texcoord_index)
+                return vertex;
+        }
+
+        uint32_t vertex = uint32_t(geometry.positions.size());
+        vertex_keys.push_back(idx);
+        next_vertex.push_back(first_vertex[idx.vertex_index]);
+        first_vertex[idx.vertex_index] = vertex;
 
-                material = make_shared<Lambertian>(albedo);
+        // Vertex position
+        tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
+        tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
+        tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
+        geometry.positions.push_back(point3(vx, vy, vz));
+
+        // If normal_index is negative, there is no normal data
+        if (has_normals)
+        {
+            if (idx.normal_index >= 0)
+            {
+                tinyobj::real_t nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
+                tinyobj::real_t ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
+                tinyobj::real_t nz = attrib.normals[3 * size_t(idx.normal_index) + 2];
+                geometry.normals.push_back(vec3(nx, ny, nz));
             }
-            // Else, load diffuse texture
             else
+                geometry.normals.push_back(vec3(0.0));
+        }
+
+        // If texcoord_index is negative, there is no texture coordinate data
+        if (has_uvs)
+        {
+            if (idx.texcoord_index >= 0)
             {
-                auto texture_name = materials[material_id].diffuse_texname;
-                auto texture = make_shared<ImageTexture>(obj_path_fs.parent_path().string() + "/" + texture_name);
-                material = make_shared<Lambertian>(texture);
-                texture_names.push_back(texture_name);
+                tinyobj::real_t u = attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
+                tinyobj::real_t v = attrib.texcoords[2 * size_t(idx.texcoord_index) + 1];
+                geometry.uvs.push_back(make_pair(u, v));
             }
+            else
+                geometry.uvs.push_back(make_pair(0.0, 0.0));
         }
 
+        // Vertex color
+        if (has_colors)
+        {
+            tinyobj::real_t red = attrib.colors[3 * size_t(idx.vertex_index) + 0];
+            tinyobj::real_t green = attrib.colors[3 * size_t(idx.vertex_index) + 1];
+            tinyobj::real_t blue = attrib.colors[3 * size_t(idx.vertex_index) + 2];
+            geometry.colors.push_back(color(red, green, blue));
+        }
+
+        return vertex;
+    };
+
+    // Loop over shapes (surfaces)
+    for (size_t s = 0; s < shapes.size(); s++)
+    {
         size_t index_offset = 0;
 
         // Loop over faces (primitives / polygon)
@@ -92,69 +169,34 @@ shared_ptr<Mesh> load_obj(const string& filename)
 
             // Ignore non-triangle primitives
             if (fv != 3)
+            {
+                index_offset += fv;
                 continue;
+            }
 
-            // Create empty triangle
-            shared_ptr<Triangle> triangle;
-            vertex vertices[3];
-
-            // Loop over vertices in the face.
+            // Add the triangle corners to the index buffer
             for (size_t v = 0; v < fv; v++)
-            {
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-                // Vertex data pointer
-                vertex& current_vertex = vertices[v];
-
-                // Vertex position
-                tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
-                tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
-                tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
-                current_vertex.position = point3(vx, vy, vz);
-
-                // If normal_index is negative, there is no normal data
-                if (idx.normal_index >= 0)
-                {
-                    // Vertex normal
-                    tinyobj::real_t nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
-                    tinyobj::real_t ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
-                    tinyobj::real_t nz = attrib.normals[3 * size_t(idx.normal_index) + 2];
-                    current_vertex.normal = point3(nx, ny, nz);
-                }
-
-                // If texcoord_index is negative, there is no texture coordinate data
-                if (idx.texcoord_index >= 0)
-                {
-                    // Vertex texture coordinate
-                    tinyobj::real_t u = attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
-                    tinyobj::real_t v = attrib.texcoords[2 * size_t(idx.texcoord_index) + 1];
-                    current_vertex.uv = make_pair(u, v);
-                }
-
-                // Vertex color
-                tinyobj::real_t red = attrib.colors[3 * size_t(idx.vertex_index) + 0];
-                tinyobj::real_t green = attrib.colors[3 * size_t(idx.vertex_index) + 1];
-                tinyobj::real_t blue = attrib.colors[3 * size_t(idx.vertex_index) + 2];
-                current_vertex.color = color(red, green, blue);
-            }
+                geometry.indices.push_back(find_or_add_vertex(shapes[s].mesh.indices[index_offset + v]));
 
-            // Create and add triangle
-            triangle = make_shared<Triangle>(vertices[0], vertices[1], vertices[2], material);
-            triangles->add(triangle);
+            // Per-face material, where -1 means the face has none
+            int material_id = shapes[s].mesh.material_ids[f];
+            material_id = (material_id < 0 || material_id >= int(geometry.materials.size())) ? 0 : material_id;
+            geometry.material_ids.push_back(uint16_t(material_id));
 
             index_offset += fv;
-
-            // per-face material
-            // shapes[s].mesh.material_ids[f];
         }
-
-        // Create and add surface
-        surface = make_shared<Surface>(triangles, material);
-        surfaces->add(surface);
     }
 
+    // Drop the growth slack of the buffers, the mesh keeps them for the whole render
+    geometry.positions.shrink_to_fit();
+    geometry.normals.shrink_to_fit();
+    geometry.uvs.shrink_to_fit();
+    geometry.colors.shrink_to_fit();
+    geometry.indices.shrink_to_fit();
+    geometry.material_ids.shrink_to_fit();
+
     // Create mesh
-    auto mesh = make_shared<Mesh>(filename, surfaces, material_names, texture_names);
+    auto mesh = make_shared<Mesh>(filename, std::move(geometry), int(shapes.size()), material_names, texture_names, bvh_settings);
 
     return mesh;
 }
\ No newline at end of file
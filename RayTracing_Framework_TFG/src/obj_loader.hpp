@@ -2,9 +2,10 @@
 
 // Headers
 #include "core.hpp"
+#include "bvh_split.hpp"
 
 // Forward declarations
 class Mesh;
 
-shared_ptr<Mesh> load_obj(const string& filename);
+shared_ptr<Mesh> load_obj(const string& filename, const BVHSettings& bvh_settings = BVHSettings());
 
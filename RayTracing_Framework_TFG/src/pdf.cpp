@@ -8,60 +8,57 @@
 
 uniform_sphere_pdf::uniform_sphere_pdf() {}
 
-double uniform_sphere_pdf::value(const vec3& direction) const 
+double uniform_sphere_pdf::value(const vec3& direction, Sampler& sampler) const 
 {
     return 1 / (4 * pi);
 }
 
-vec3 uniform_sphere_pdf::generate() const 
+vec3 uniform_sphere_pdf::generate(Sampler& sampler) const 
 {
-    return random_unit_vector();
+    return random_unit_vector(sampler);
 }
 
-cosine_hemisphere_pdf::cosine_hemisphere_pdf(const vec3& normal)
-{
-    uvw = make_shared<ONB>(normal);
-}
+cosine_hemisphere_pdf::cosine_hemisphere_pdf(const vec3& normal) : uvw(normal) {}
 
-double cosine_hemisphere_pdf::value(const vec3& direction) const
+double cosine_hemisphere_pdf::value(const vec3& direction, Sampler& sampler) const
 {
-    auto cosine_theta = dot(unit_vector(direction), uvw->w());
+    auto cosine_theta = dot(unit_vector(direction), uvw.w());
     return std::fmax(0, cosine_theta / pi);
 }
 
-vec3 cosine_hemisphere_pdf::generate() const
+vec3 cosine_hemisphere_pdf::generate(Sampler& sampler) const
 {
     // Generate a random cosine-weighted hemisphere direction
-    vec3 scatter_direction = random_cosine_hemisphere_direction();
+    vec3 scatter_direction = random_cosine_hemisphere_direction(sampler);
 
     // Intercept degenerate scatter direction (if the direction is near zero, scatter along the normal)
     // if (scatter_direction.near_zero())
         // scatter_direction = uvw.w(); 
 
     // Transform the scatter direction to the uvw space and normalize it
-    scatter_direction = uvw->transform(scatter_direction);
+    scatter_direction = uvw.transform(scatter_direction);
     scatter_direction.normalize();
     return scatter_direction;
 }
 
-hittable_pdf::hittable_pdf(shared_ptr<Hittable> object, const point3& hit_point)
+hittable_pdf::hittable_pdf(const Hittable* object, const point3& hit_point)
     : object(object), hit_point(hit_point)
 {}
 
-double hittable_pdf::value(const vec3& direction) const 
+double hittable_pdf::value(const vec3& direction, Sampler& sampler) const 
 {
-    return object->pdf_value(hit_point, direction);
+    return object->pdf_value(hit_point, direction, sampler);
 }
-vec3 hittable_pdf::generate() const 
+vec3 hittable_pdf::generate(Sampler& sampler) const 
 {
-    return object->random_scattering_ray(hit_point);
+    return object->random_scattering_ray(hit_point, sampler);
 }
 
-hittables_pdf::hittables_pdf(const vector<shared_ptr<Hittable>>& hittables, const point3& hit_point)
+hittables_pdf::hittables_pdf(const vector<const Hittable*>& hittables, const point3& hit_point)
     : hittables(hittables), hit_point(hit_point)
 {}
 
-double hittables_pdf::value(const vec3& scattering_direction) const 
+double hittables_pdf::value(const vec3& scattering_direction, Sampler& sampler) const 
 {
     auto size = hittables.size();
     auto weight = 1.0 / size;
@@ -69,36 +66,36 @@ double hittables_pdf::value(const vec3& scattering_direction) const
 
     for (int i = 0; i < size; i++)
     {
-        const auto& object = hittables[i];
-        sum += weight * object->pdf_value(hit_point, scattering_direction);
+        const Hittable* object = hittables[i];
+        sum += weight * object->pdf_value(hit_point, scattering_direction, sampler);
     }
 
     return sum;
 }
 
-vec3 hittables_pdf::generate() const 
+vec3 hittables_pdf::generate(Sampler& sampler) const 
 {
     auto size = int(hittables.size());
-    auto random_object_index = random_int(0, size - 1);
-    return hittables[random_object_index]->random_scattering_ray(hit_point);
+    auto random_object_index = sampler.random_int(0, size - 1);
+    return hittables[random_object_index]->random_scattering_ray(hit_point, sampler);
 }
 
-mixture_pdf::mixture_pdf(shared_ptr<PDF> p0, shared_ptr<PDF> p1)
+mixture_pdf::mixture_pdf(const PDF* p0, const PDF* p1)
 {
     p[0] = p0;
     p[1] = p1;
 }
 
-double mixture_pdf::value(const vec3& direction) const 
+double mixture_pdf::value(const vec3& direction, Sampler& sampler) const 
 {
-    return 0.5 * p[0]->value(direction) + 0.5 * p[1]->value(direction);
+    return 0.5 * p[0]->value(direction, sampler) + 0.5 * p[1]->value(direction, sampler);
 }
 
-vec3 mixture_pdf::generate() const 
+vec3 mixture_pdf::generate(Sampler& sampler) const 
 {
-    if (random_double() < 0.5)
-        return p[0]->generate();
+    if (sampler.random_double() < 0.5)
+        return p[0]->generate(sampler);
     else
-        return p[1]->generate();
+        return p[1]->generate(sampler);
 }
 
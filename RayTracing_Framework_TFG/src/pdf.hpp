@@ -3,18 +3,19 @@
 // Headers
 #include "core.hpp"
 #include "vec3.hpp"
+#include "onb.hpp"
 
 // Forward declarations
-class ONB;
 class Hittable;
+class Sampler;
 
-class PDF // Probability Distribution Function (PDF)
+class PDF // Probability Distribution Function (PDF). Per-bounce PDFs live in the thread's MemoryArena, so they hold no owning pointers.
 { 
 public:
     virtual ~PDF() {};
 
-    virtual double value(const vec3& direction) const = 0;
-    virtual vec3 generate() const = 0;
+    virtual double value(const vec3& direction, Sampler& sampler) const = 0;
+    virtual vec3 generate(Sampler& sampler) const = 0;
 };
 
 class uniform_sphere_pdf : public PDF 
@@ -22,8 +23,8 @@ class uniform_sphere_pdf : public PDF
 public:
     uniform_sphere_pdf();
 
-    double value(const vec3& direction) const override;
-    vec3 generate() const override;
+    double value(const vec3& direction, Sampler& sampler) const override;
+    vec3 generate(Sampler& sampler) const override;
 };
 
 class cosine_hemisphere_pdf : public PDF 
@@ -31,49 +32,49 @@ class cosine_hemisphere_pdf : public PDF
 public:
     cosine_hemisphere_pdf(const vec3& normal); // Generate a orthonormal basis of the hit point surface normal
 
-    double value(const vec3& direction) const override;
-    vec3 generate() const override;
+    double value(const vec3& direction, Sampler& sampler) const override;
+    vec3 generate(Sampler& sampler) const override;
 
 private:
-    shared_ptr<ONB> uvw;
+    ONB uvw;
 };
 
 class hittable_pdf : public PDF
 {
 public:
-    hittable_pdf(shared_ptr<Hittable> object, const point3& hit_point);
+    hittable_pdf(const Hittable* object, const point3& hit_point);
 
-    double value(const vec3& direction) const override;
-    vec3 generate() const override;
+    double value(const vec3& direction, Sampler& sampler) const override;
+    vec3 generate(Sampler& sampler) const override;
 
 private:
-    shared_ptr<Hittable> object;
+    const Hittable* object;
     point3 hit_point;
 };
 
 class hittables_pdf : public PDF 
 {
 public:
-    hittables_pdf(const vector<shared_ptr<Hittable>>& hittables, const point3& hit_point);
+    hittables_pdf(const vector<const Hittable*>& hittables, const point3& hit_point);
 
-    double value(const vec3& scattering_direction) const override;
-    vec3 generate() const override;
+    double value(const vec3& scattering_direction, Sampler& sampler) const override;
+    vec3 generate(Sampler& sampler) const override;
 
 private:
-    const vector<shared_ptr<Hittable>>& hittables;
+    const vector<const Hittable*>& hittables;
     point3 hit_point;
 };
 
 class mixture_pdf : public PDF 
 {
 public:
-    mixture_pdf(shared_ptr<PDF> p0, shared_ptr<PDF> p1);
+    mixture_pdf(const PDF* p0, const PDF* p1);
 
-    double value(const vec3& direction) const override;
-    vec3 generate() const override;
+    double value(const vec3& direction, Sampler& sampler) const override;
+    vec3 generate(Sampler& sampler) const override;
 
 private:
-    shared_ptr<PDF> p[2];
+    const PDF* p[2];
 };
 
 
@@ -2,6 +2,7 @@
 #include "core.hpp" 
 #include "quad.hpp"
 #include "utilities.hpp"
+#include "ray_stats.hpp"
 #include "aabb.hpp"
 #include "ray.hpp"
 #include "matrix.hpp"
@@ -26,31 +27,33 @@ void Quad::set_bounding_box()
     // Compute the bounding box of all four vertices.
     auto bbox_diagonal1 = AABB(Q, Q + u + v);
     auto bbox_diagonal2 = AABB(Q + u, Q + v);
-    bbox = make_shared<AABB>(bbox_diagonal1, bbox_diagonal2);
+    bbox = AABB(bbox_diagonal1, bbox_diagonal2);
 }
 
-shared_ptr<AABB> Quad::bounding_box() const
+const AABB& Quad::bounding_box() const
 { 
     return bbox; 
 }
 
-bool Quad::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool Quad::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-    auto denom = dot(normal, r->direction());
+    RayStats::local().primitives_tested++;
+
+    auto denom = dot(normal, r.direction());
 
     // No hit if the ray is parallel to the plane.
     if (std::fabs(denom) < kEpsilon)
         return false;
 
     // Calculate the ray intersection value
-    auto t = (D - dot(normal, r->origin())) / denom;
+    auto t = (D - dot(normal, r.origin())) / denom;
 
     // Return false if the hit point parameter t is outside the ray interval.
     if (!ray_t.surrounds(t))
         return false;
 
     // Intersection point
-    auto P = r->at(t);
+    auto P = r.at(t);
 
     // Obtain intersection point's planar coordinates of the coordinate frame determined by the plane determined by Q, u and v
     vec3 phit = P - Q; // Intersection point's vector expressed in plane basis coordinates
@@ -62,36 +65,35 @@ bool Quad::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>&
         return false;
 
     // Hit record
-    auto quad_rec = make_shared<quad_hit_record>();
-    quad_rec->t = t;
-    quad_rec->p = P;
-    quad_rec->material = material;
-    quad_rec->texture_coordinates = make_pair(alpha, beta);
-    quad_rec->determine_normal_direction(r->direction(), normal);
-
-    // Polymorphic assignment
-    rec = quad_rec;
+    rec.t = t;
+    rec.p = P;
+    rec.material = material.get();
+    rec.texture_coordinates = make_pair(alpha, beta);
+    rec.type = QUAD;
+    rec.determine_normal_direction(r.direction(), normal);
 
     return true;
 }
 
-double Quad::pdf_value(const point3& hit_point, const vec3& scattering_direction) const
+double Quad::pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const
 {
-    shared_ptr<hit_record> rec;
-    auto ray = make_shared<Ray>(hit_point, scattering_direction);
+    hit_record rec;
+    auto ray = Ray(hit_point, scattering_direction);
+
+    RayStats::local().count_ray(SHADOW_RAY, sampler.bounce());
 
-    if (!this->hit(ray, Interval(0.001, infinity), rec))
+    if (!this->hit(ray, Interval(hit_epsilon(ray, 0.001), infinity), rec, sampler))
         return 0;
 
-    auto distance_squared = rec->t * rec->t * scattering_direction.length_squared(); // light_hit_point - origin = t * direction
-    auto cosine = fabs(dot(scattering_direction, rec->normal) / scattering_direction.length()); // scattering direction is not normalized
+    auto distance_squared = rec.t * rec.t * scattering_direction.length_squared(); // light_hit_point - origin = t * direction
+    auto cosine = fabs(dot(scattering_direction, rec.normal) / scattering_direction.length()); // scattering direction is not normalized
 
     return distance_squared / (cosine * area);
 }
 
-vec3 Quad::random_scattering_ray(const point3& hit_point) const
+vec3 Quad::random_scattering_ray(const point3& hit_point, Sampler& sampler) const
 {
-    auto p = Q + (random_double() * u) + (random_double() * v);
+    auto p = Q + (sampler.random_double() * u) + (sampler.random_double() * v);
     return p - hit_point;
 }
 
@@ -9,18 +9,18 @@ public:
     Quad(point3 Q, vec3 u, vec3 v, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model = nullptr, bool pdf = false);
 
     void set_bounding_box();
-    shared_ptr<AABB> bounding_box() const override;
-    bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
-    double pdf_value(const point3& hit_point, const vec3& scattering_direction) const override;
-    vec3 random_scattering_ray(const point3& hit_point) const override;
+    const AABB& bounding_box() const override;
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
+    double pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const override;
+    vec3 random_scattering_ray(const point3& hit_point, Sampler& sampler) const override;
     shared_ptr<Material> get_material();
 
 private:
     point3 Q;
-    double D;
+    real D;
     vec3 u, v, w, normal;
     double area;
     shared_ptr<Material> material;
-    shared_ptr<AABB> bbox;
+    AABB bbox;
 };
 
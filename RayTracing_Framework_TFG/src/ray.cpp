@@ -2,9 +2,9 @@
 #include "core.hpp"
 #include "ray.hpp"
 
-Ray::Ray() {}
+Ray::Ray() : tm(0) {}
 
-Ray::Ray(const point3& origin, const vec3& direction) : orig(origin), dir(direction) {}
+Ray::Ray(const point3& origin, const vec3& direction) : orig(origin), dir(direction), tm(0) {}
 
 Ray::Ray(const point3& origin, const vec3& direction, double time) : orig(origin), dir(direction), tm(time) {}
 
@@ -22,7 +22,7 @@ const double Ray::time() const
     return tm;
 }
 
-point3 Ray::at(double t) const
+point3 Ray::at(real t) const
 {
     return orig + t * dir;
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ public:
     const point3& origin() const;
     const vec3& direction() const;
     const double time() const;
-    point3 at(double t) const;
+    point3 at(real t) const;
 
 private:
     point3 orig;
@@ -24,5 +24,20 @@ private:
 // Aliases
 using motion_vector = Ray;
 
+// Smallest hit distance along the ray that clears the rounding error of its origin. The error of a computed hit point grows
+// with its magnitude, so the bound is relative to the largest origin coordinate, with min_distance as an absolute floor.
+inline real hit_epsilon(const Ray& r, real min_distance)
+{
+    const point3& origin = r.origin();
+    real origin_error = hit_epsilon_scale * std::max({ std::fabs(origin.x), std::fabs(origin.y), std::fabs(origin.z) });
+    real length_squared = r.direction().length_squared();
+
+    // Compare squared distances, so the common case where the floor wins needs no square root
+    if (origin_error * origin_error <= min_distance * min_distance * length_squared)
+        return min_distance;
+
+    return origin_error / std::sqrt(length_squared);
+}
+
 
 
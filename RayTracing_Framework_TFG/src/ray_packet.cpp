@@ -0,0 +1,103 @@
+﻿// Headers
+#include "core.hpp"
+#include "ray_packet.hpp"
+#include "ray.hpp"
+#include "aabb.hpp"
+
+void RayPacket::clear()
+{
+    size = 0;
+    hits = 0;
+    coherent = false;
+}
+
+void RayPacket::add(const Ray& r, Sampler* sampler, double t_min, double t_max)
+{
+    rays[size] = r;
+    samplers[size] = sampler;
+    this->t_min[size] = t_min;
+    this->t_max[size] = t_max;
+    size++;
+}
+
+void RayPacket::compute_bounds()
+{
+    coherent = size > 0;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        origin_min[axis] = inverse_direction_min[axis] = infinity;
+        origin_max[axis] = inverse_direction_max[axis] = -infinity;
+        bool positive = false, negative = false;
+
+        for (int i = 0; i < size; i++)
+        {
+            double origin = rays[i].origin()[axis];
+            double direction = rays[i].direction()[axis];
+            double inverse_direction = 1.0 / direction;
+
+            origin_min[axis] = std::min(origin_min[axis], origin);
+            origin_max[axis] = std::max(origin_max[axis], origin);
+            inverse_direction_min[axis] = std::min(inverse_direction_min[axis], inverse_direction);
+            inverse_direction_max[axis] = std::max(inverse_direction_max[axis], inverse_direction);
+
+            if (direction > 0) positive = true;
+            else if (direction < 0) negative = true;
+            else positive = negative = true;
+        }
+
+        // Mixed or zero direction signs make the slab intervals unbounded
+        if (positive == negative)
+            coherent = false;
+    }
+}
+
+uint32_t RayPacket::all_active() const
+{
+    return size >= 32 ? ~0u : (1u << size) - 1;
+}
+
+bool RayPacket::may_hit(const AABB& box, uint32_t active) const
+{
+    if (!coherent)
+        return true;
+
+    // Smallest t_min and largest t_max of the active rays
+    double packet_t_min = infinity;
+    double packet_t_max = -infinity;
+    for (int i = 0; i < size; i++)
+    {
+        if (active >> i & 1)
+        {
+            packet_t_min = std::min(packet_t_min, t_min[i]);
+            packet_t_max = std::max(packet_t_max, t_max[i]);
+        }
+    }
+
+    double enter = packet_t_min;
+    double exit = packet_t_max;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const auto& interval = box.axis_interval(axis);
+        bool positive = inverse_direction_min[axis] > 0;
+
+        // Near and far slab planes are the same for every ray of a coherent packet
+        double near_plane = positive ? interval.min : interval.max;
+        double far_plane = positive ? interval.max : interval.min;
+
+        // Lower bound of the near plane distance and upper bound of the far plane distance over the whole packet
+        double near_lo = std::min({ (near_plane - origin_min[axis]) * inverse_direction_min[axis], (near_plane - origin_min[axis]) * inverse_direction_max[axis],
+                                    (near_plane - origin_max[axis]) * inverse_direction_min[axis], (near_plane - origin_max[axis]) * inverse_direction_max[axis] });
+        double far_hi = std::max({ (far_plane - origin_min[axis]) * inverse_direction_min[axis], (far_plane - origin_min[axis]) * inverse_direction_max[axis],
+                                   (far_plane - origin_max[axis]) * inverse_direction_min[axis], (far_plane - origin_max[axis]) * inverse_direction_max[axis] });
+
+        enter = std::max(enter, near_lo);
+        exit = std::min(exit, far_hi);
+
+        if (exit <= enter)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "ray.hpp"
+#include "hittable.hpp"
+
+// Forward declarations
+class AABB;
+class Sampler;
+
+constexpr int ray_packet_max_size = 16;
+
+struct RayPacket // Group of up to 16 coherent rays traced through the BVH together
+{
+public:
+    int size = 0;
+    array<Ray, ray_packet_max_size> rays;
+    array<double, ray_packet_max_size> t_min;                       // Lower bound of each ray interval, raised with the ray origin rounding error
+    array<double, ray_packet_max_size> t_max;                       // Closest hit found so far per ray
+    array<hit_record, ray_packet_max_size> records;                 // Closest hit record per ray (only valid where hits has the ray's bit set)
+    uint32_t hits = 0;                                              // One bit per ray that found a hit
+    array<Sampler*, ray_packet_max_size> samplers;                  // Random number context of each ray's pixel sample
+
+    void clear();
+    void add(const Ray& r, Sampler* sampler, double t_min, double t_max);
+    void compute_bounds();                                          // Must be called after the last add and before traversal
+    uint32_t all_active() const;
+
+    // Conservative whole-packet test: false only if no active ray can hit the box. Uses interval arithmetic over the
+    // origin and inverse direction bounds of the packet, so it only culls when every direction component shares its sign.
+    bool may_hit(const AABB& box, uint32_t active) const;
+
+private:
+    bool coherent = false;                                          // Every direction axis has a single sign
+    array<double, 3> origin_min, origin_max;
+    array<double, 3> inverse_direction_min, inverse_direction_max;
+};
@@ -0,0 +1,99 @@
+﻿// Headers
+#include "core.hpp"
+#include "ray_queue.hpp"
+#include "ray.hpp"
+#include "aabb.hpp"
+#include "utilities.hpp"
+
+int RayQueue::size() const
+{
+    return int(path.size());
+}
+
+bool RayQueue::empty() const
+{
+    return path.empty();
+}
+
+void RayQueue::clear()
+{
+    origin_x.clear(); origin_y.clear(); origin_z.clear();
+    direction_x.clear(); direction_y.clear(); direction_z.clear();
+    time.clear();
+    throughput_r.clear(); throughput_g.clear(); throughput_b.clear();
+    path.clear();
+    samplers.clear();
+}
+
+void RayQueue::reserve(int capacity)
+{
+    origin_x.reserve(capacity); origin_y.reserve(capacity); origin_z.reserve(capacity);
+    direction_x.reserve(capacity); direction_y.reserve(capacity); direction_z.reserve(capacity);
+    time.reserve(capacity);
+    throughput_r.reserve(capacity); throughput_g.reserve(capacity); throughput_b.reserve(capacity);
+    path.reserve(capacity);
+    samplers.reserve(capacity);
+}
+
+void RayQueue::push(const Ray& r, const color& throughput, int path, const Sampler& sampler)
+{
+    const point3& origin = r.origin();
+    const vec3& direction = r.direction();
+
+    origin_x.push_back(origin.x); origin_y.push_back(origin.y); origin_z.push_back(origin.z);
+    direction_x.push_back(direction.x); direction_y.push_back(direction.y); direction_z.push_back(direction.z);
+    time.push_back(r.time());
+    throughput_r.push_back(throughput.x); throughput_g.push_back(throughput.y); throughput_b.push_back(throughput.z);
+    this->path.push_back(path);
+    samplers.push_back(sampler);
+}
+
+Ray RayQueue::ray(int index) const
+{
+    point3 origin(origin_x[index], origin_y[index], origin_z[index]);
+    vec3 direction(direction_x[index], direction_y[index], direction_z[index]);
+
+    return Ray(origin, direction, time[index]);
+}
+
+color RayQueue::throughput(int index) const
+{
+    return color(throughput_r[index], throughput_g[index], throughput_b[index]);
+}
+
+vector<uint64_t> RayQueue::sort_keys(const AABB& bounds) const
+{
+    vector<uint64_t> keys(size());
+
+    double min_x = bounds.x.min, min_y = bounds.y.min, min_z = bounds.z.min;
+    double inv_x = 1.0 / std::max(double(bounds.x.size()), 1e-12);
+    double inv_y = 1.0 / std::max(double(bounds.y.size()), 1e-12);
+    double inv_z = 1.0 / std::max(double(bounds.z.size()), 1e-12);
+
+    for (int i = 0; i < size(); i++)
+    {
+        uint64_t octant = (direction_x[i] < 0 ? 4 : 0) | (direction_y[i] < 0 ? 2 : 0) | (direction_z[i] < 0 ? 1 : 0);
+        uint64_t morton = morton_code((origin_x[i] - min_x) * inv_x, (origin_y[i] - min_y) * inv_y, (origin_z[i] - min_z) * inv_z);
+        keys[i] = (octant << 30) | morton;
+    }
+
+    return keys;
+}
+
+void RayQueue::permute(const vector<int>& order)
+{
+    auto gather = [&](auto& values)
+    {
+        std::remove_reference_t<decltype(values)> permuted(values.size());
+        for (size_t i = 0; i < order.size(); i++)
+            permuted[i] = values[order[i]];
+        values.swap(permuted);
+    };
+
+    gather(origin_x); gather(origin_y); gather(origin_z);
+    gather(direction_x); gather(direction_y); gather(direction_z);
+    gather(time);
+    gather(throughput_r); gather(throughput_g); gather(throughput_b);
+    gather(path);
+    gather(samplers);
+}
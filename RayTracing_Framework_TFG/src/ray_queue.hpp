@@ -0,0 +1,36 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "vec3.hpp"
+#include "sampler.hpp"
+
+// Forward declarations
+class Ray;
+class AABB;
+
+constexpr int ray_sort_key_bits = 33;           // Direction octant (3 bits) above a 30-bit Morton code of the origin
+constexpr int ray_sort_coarse_shift = 21;       // Keeping the octant and the top three Morton levels gives the coarse key used to measure coherence
+
+struct RayQueue // Structure-of-arrays batch of path segments that the wavefront integrator traces together
+{
+public:
+    vector<double> origin_x, origin_y, origin_z;
+    vector<double> direction_x, direction_y, direction_z;
+    vector<double> time;
+    vector<double> throughput_r, throughput_g, throughput_b;   // Path weight carried up to this segment
+    vector<int> path;                                          // Batch path (pixel sample) the segment contributes to
+    vector<Sampler> samplers;                                  // Random number context of the pixel sample
+
+    int size() const;
+    bool empty() const;
+    void clear();
+    void reserve(int capacity);
+
+    void push(const Ray& r, const color& throughput, int path, const Sampler& sampler);
+    Ray ray(int index) const;
+    color throughput(int index) const;
+
+    vector<uint64_t> sort_keys(const AABB& bounds) const;  // Direction octant plus origin Morton key of every segment, with origins normalized to bounds
+    void permute(const vector<int>& order);                 // Reorders the segments so that segment i becomes the old segment order[i]
+};
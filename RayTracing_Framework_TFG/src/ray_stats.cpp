@@ -0,0 +1,210 @@
+﻿// Headers
+#include "core.hpp"
+#include "ray_stats.hpp"
+
+// Counts made by threads without a bound block land here and are never reported
+static thread_local RayStats unbound_stats;
+static thread_local RayStats* active_stats = &unbound_stats;
+
+#ifdef RT_COUNT_ALLOCATIONS
+
+// Platform Headers
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Global allocation hooks that feed the allocation counter of the calling thread. They replace every allocation of the
+// program, so they are only compiled into builds defining RT_COUNT_ALLOCATIONS.
+static void* counted_malloc(size_t size, size_t alignment)
+{
+    active_stats->allocations++;
+    size = size ? size : 1;
+
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        return std::malloc(size);
+
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void counted_free(void* memory, size_t alignment)
+{
+#ifdef _WIN32
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        _aligned_free(memory);
+        return;
+    }
+#endif
+
+    std::free(memory);
+}
+
+void* operator new(size_t size)
+{
+    if (void* memory = counted_malloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* memory = counted_malloc(size, size_t(alignment)))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return counted_malloc(size, size_t(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept
+{
+    counted_free(memory, size_t(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+    counted_free(memory, size_t(alignment));
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept
+{
+    counted_free(memory, size_t(alignment));
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept
+{
+    counted_free(memory, size_t(alignment));
+}
+
+#endif
+
+void RayStats::count_ray(RAY_KIND kind, int depth)
+{
+    rays_by_kind[kind]++;
+    rays_by_depth[std::min(depth, ray_stats_max_depth - 1)]++;
+}
+
+uint64_t RayStats::total_rays() const
+{
+    uint64_t total = 0;
+
+    for (auto count : rays_by_kind)
+        total += count;
+
+    return total;
+}
+
+int RayStats::max_depth_reached() const
+{
+    for (int depth = ray_stats_max_depth - 1; depth >= 0; depth--)
+    {
+        if (rays_by_depth[depth] > 0)
+            return depth;
+    }
+
+    return -1;
+}
+
+void RayStats::reset()
+{
+    *this = RayStats();
+}
+
+RayStats& RayStats::operator+=(const RayStats& stats)
+{
+    for (int kind = 0; kind < RAY_KINDS; kind++)
+        rays_by_kind[kind] += stats.rays_by_kind[kind];
+
+    for (int depth = 0; depth < ray_stats_max_depth; depth++)
+        rays_by_depth[depth] += stats.rays_by_depth[depth];
+
+    bvh_nodes_visited += stats.bvh_nodes_visited;
+    primitives_tested += stats.primitives_tested;
+    packets_traced += stats.packets_traced;
+    packet_nodes_visited += stats.packet_nodes_visited;
+    packet_nodes_culled += stats.packet_nodes_culled;
+    packet_fallback_rays += stats.packet_fallback_rays;
+    rays_sorted += stats.rays_sorted;
+    ray_sort_pairs += stats.ray_sort_pairs;
+    ray_sort_coherent_before += stats.ray_sort_coherent_before;
+    ray_sort_coherent_after += stats.ray_sort_coherent_after;
+    allocations += stats.allocations;
+
+    return *this;
+}
+
+RayStats& RayStats::local()
+{
+    return *active_stats;
+}
+
+void RayStats::bind(RayStats* stats)
+{
+    active_stats = stats ? stats : &unbound_stats;
+}
+
+string RayStats::kind_name(RAY_KIND kind)
+{
+    switch (kind)
+    {
+    case CAMERA_RAY: return "Camera";
+    case DIFFUSE_RAY: return "Diffuse";
+    case SPECULAR_RAY: return "Specular";
+    case SHADOW_RAY: return "Shadow";
+    case VOLUME_RAY: return "Volume";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+enum RAY_KIND
+{
+    CAMERA_RAY,
+    DIFFUSE_RAY,
+    SPECULAR_RAY,
+    SHADOW_RAY,     // Light probe rays traced by the hittable PDFs towards emissive objects
+    VOLUME_RAY,
+    RAY_KINDS
+};
+
+constexpr int ray_stats_max_depth = 64; // Bounces deeper than this are counted in the last bucket
+
+// Heap allocations are only counted by builds defining RT_COUNT_ALLOCATIONS, which replace the global operator new
+#ifdef RT_COUNT_ALLOCATIONS
+constexpr bool ray_stats_count_allocations = true;
+#else
+constexpr bool ray_stats_count_allocations = false;
+#endif
+
+struct alignas(64) RayStats // Per-thread ray counter block. Aligned to a cache line so neighbouring blocks never share one.
+{
+public:
+    array<uint64_t, RAY_KINDS> rays_by_kind = {};
+    array<uint64_t, ray_stats_max_depth> rays_by_depth = {};
+    uint64_t bvh_nodes_visited = 0;
+    uint64_t primitives_tested = 0;
+    uint64_t packets_traced = 0;
+    uint64_t packet_nodes_visited = 0;
+    uint64_t packet_nodes_culled = 0;       // Packet node visits rejected by the interval arithmetic test
+    uint64_t packet_fallback_rays = 0;      // Rays that left their diverged packet to finish traversal alone
+    uint64_t rays_sorted = 0;
+    uint64_t ray_sort_pairs = 0;            // Neighbouring queue positions seen by the ray sorter
+    uint64_t ray_sort_coherent_before = 0;  // Neighbours sharing octant and coarse origin cell before sorting
+    uint64_t ray_sort_coherent_after = 0;   // Neighbours sharing octant and coarse origin cell after sorting
+    uint64_t allocations = 0;               // Heap allocations made by the thread while the block was bound (RT_COUNT_ALLOCATIONS builds only)
+
+    void count_ray(RAY_KIND kind, int depth);
+    uint64_t total_rays() const;
+    int max_depth_reached() const;
+    void reset();
+
+    RayStats& operator+=(const RayStats& stats);
+
+    static RayStats& local();               // Counter block bound to the calling thread
+    static void bind(RayStats* stats);      // Binds a counter block to the calling thread (nullptr discards counts)
+    static string kind_name(RAY_KIND kind);
+};
@@ -0,0 +1,92 @@
+﻿// Headers
+#include "core.hpp"
+#include "sampler.hpp"
+
+// PCG32 constants
+constexpr uint64_t pcg32_default_state = 0x853c49e6748fea9bULL;
+constexpr uint64_t pcg32_default_stream = 0xda3e39cb94b95bdbULL;
+constexpr uint64_t pcg32_multiplier = 0x5851f42d4c957f2dULL;
+
+Sampler::Sampler() : state(pcg32_default_state), increment(pcg32_default_stream) {}
+
+Sampler::Sampler(uint64_t seed)
+{
+    set_sequence(mix_bits(seed));
+}
+
+void Sampler::start_pixel_sample(int pixel_index, int sample_index)
+{
+    _pixel_index = pixel_index;
+    _sample_index = sample_index;
+    start_bounce(0);
+}
+
+void Sampler::start_bounce(int bounce)
+{
+    _bounce = bounce;
+
+    // Hash the (pixel, sample, bounce) triple into the stream sequence
+    uint64_t key = mix_bits((uint64_t(uint32_t(_pixel_index)) << 32) | uint32_t(_sample_index));
+    set_sequence(mix_bits(key ^ uint64_t(uint32_t(bounce))));
+}
+
+int Sampler::pixel_index() const
+{
+    return _pixel_index;
+}
+
+int Sampler::sample_index() const
+{
+    return _sample_index;
+}
+
+int Sampler::bounce() const
+{
+    return _bounce;
+}
+
+uint32_t Sampler::random_uint32()
+{
+    // XSH RR output function
+    uint64_t old_state = state;
+    state = old_state * pcg32_multiplier + increment;
+    uint32_t xor_shifted = uint32_t(((old_state >> 18u) ^ old_state) >> 27u);
+    uint32_t rotation = uint32_t(old_state >> 59u);
+    return (xor_shifted >> rotation) | (xor_shifted << ((~rotation + 1u) & 31));
+}
+
+double Sampler::random_double()
+{
+    // 2^-32 keeps the result strictly below one
+    return random_uint32() * 0x1p-32;
+}
+
+double Sampler::random_double(double min, double max)
+{
+    return min + (max - min) * random_double();
+}
+
+int Sampler::random_int(int min, int max)
+{
+    return int(random_double(min, max + 1));
+}
+
+void Sampler::set_sequence(uint64_t sequence)
+{
+    state = 0u;
+    increment = (sequence << 1u) | 1u;
+    random_uint32();
+    state += pcg32_default_state;
+    random_uint32();
+}
+
+uint64_t Sampler::mix_bits(uint64_t v)
+{
+    // SplitMix64 finalizer
+    v ^= (v >> 31);
+    v *= 0x7fb5d329728ea185ULL;
+    v ^= (v >> 27);
+    v *= 0x81dadef4bc2dd44dULL;
+    v ^= (v >> 33);
+    return v;
+}
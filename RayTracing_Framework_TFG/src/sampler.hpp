@@ -0,0 +1,35 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+class Sampler // Random number context of a render thread, built on a PCG32 generator (https://www.pcg-random.org)
+{
+public:
+    Sampler();                              // Fixed default stream
+    Sampler(uint64_t seed);                 // Stream selected by seed
+
+    // Deterministic streams: every (pixel, sample, bounce) triple owns an independent stream, so the random numbers a
+    // path consumes never depend on the thread that renders it nor on how many numbers earlier bounces consumed.
+    void start_pixel_sample(int pixel_index, int sample_index);
+    void start_bounce(int bounce);          // Bounce 0 belongs to the camera ray sample
+
+    int pixel_index() const;
+    int sample_index() const;
+    int bounce() const;
+
+    uint32_t random_uint32();
+    double random_double();                 // Returns a random real in [0,1).
+    double random_double(double min, double max); // Returns a random real in [min,max).
+    int random_int(int min, int max);       // Returns a random integer in [min,max].
+
+private:
+    uint64_t state;
+    uint64_t increment;
+    int _pixel_index = 0;
+    int _sample_index = 0;
+    int _bounce = 0;
+
+    void set_sequence(uint64_t sequence);
+    static uint64_t mix_bits(uint64_t v);
+};
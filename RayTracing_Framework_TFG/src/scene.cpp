@@ -8,6 +8,9 @@
 #include "quad.hpp"
 #include "mesh.hpp"
 #include "bvh.hpp"
+#include "linear_bvh.hpp"
+#include "ray_packet.hpp"
+#include "ray_stats.hpp"
 #include "material.hpp"
 #include "camera.hpp"
 #include "image_writer.hpp"
@@ -88,6 +91,14 @@ void Scene::add(shared_ptr<Hittable> object)
         *bvh_chrono += *bvh_node_ptr->bvh_chrono();
         break;
     }
+    case LINEAR_BVH:
+    {
+        auto linear_bvh_ptr = std::dynamic_pointer_cast<LinearBVH>(object);
+        *bvh_chrono += *linear_bvh_ptr->bvh_chrono();
+        break;
+    }
+    default: // Media and unspecified hittables add no primitives of their own
+        break;
     }
 }
 
@@ -138,11 +149,31 @@ void Scene::build(Camera& camera, ImageWriter& image)
     }
 
     // Boost scene render with BVH
-    auto BVH_tree = make_shared<bvh_node>(*this);
+    auto BVH_tree = make_shared<bvh_node>(*this, bvh_settings);
+
+    // Build the main BVH with the other split method as well, so the log can compare both trees
+    if (bvh_settings.compare_splits)
+    {
+        BVHSettings alternative_settings = bvh_settings;
+        alternative_settings.split = (bvh_settings.split == SAH_SPLIT) ? MEDIAN_SPLIT : SAH_SPLIT;
+        bvh_alternative_sah_cost = bvh_node(*this, alternative_settings).sah_cost(alternative_settings);
+    }
+
     clear();
     add(BVH_tree);
     bvh_depth = BVH_tree->depth;
     bvh_nodes = BVH_tree->nodes;
+    bvh_sah_cost = BVH_tree->sah_cost(bvh_settings);
+
+    // Flatten the BVH into the contiguous node array traced by the render threads
+    if (bvh_settings.flatten)
+    {
+        linear_bvh = make_shared<LinearBVH>(BVH_tree, bvh_settings);
+        *bvh_chrono += *linear_bvh->bvh_chrono();
+    }
+
+    // Publish the render tables
+    freeze();
 
     // End scene build time chrono
     build_chrono->end();
@@ -150,3 +181,58 @@ void Scene::build(Camera& camera, ImageWriter& image)
     // Info log
     Logger::info("Main", "Scene build completed.");
 }
+
+void Scene::freeze()
+{
+    if (linear_bvh)
+        world = linear_bvh.get();
+    else
+        world = objects.empty() ? nullptr : objects.front().get();
+
+    lights.clear();
+    for (const auto& object : hittables_with_pdf)
+        lights.push_back(object.get());
+}
+
+void Scene::intersect_packet(RayPacket& packet) const
+{
+    RayStats::local().packets_traced++;
+
+    if (world)
+        world->hit_packet(packet, packet.all_active());
+}
+
+uint64_t Scene::config_hash(const Camera& camera, const ImageWriter& image) const
+{
+    uint64_t hash = fnv1a_hash(name.data(), name.size());
+    auto add = [&](const auto& value) { hash = fnv1a_hash(&value, sizeof(value), hash); };
+
+    // Scene
+    add(primitives); add(bvh_nodes);
+    add(samples_per_pixel); add(bounce_max_depth); add(min_hit_distance);
+    add(sky_blend); add(background.x); add(background.y); add(background.z);
+
+    // BVH. The trees change the order media are sampled in, so every setting that shapes them counts. The node width is
+    // resolved, as the default depends on the CPU.
+    add(bvh_settings.split); add(bvh_settings.sah_bins); add(bvh_settings.traversal_cost); add(bvh_settings.intersection_cost);
+    add(bvh_settings.leaf_size()); add(bvh_settings.flatten); add(bvh_settings.node_width()); add(bvh_settings.simd);
+    add(bvh_settings.morton_code_bits()); add(bvh_settings.hlbvh_cluster_bits);
+
+    // Image
+    add(image.width); add(image.height);
+
+    // Camera
+    add(camera.vertical_fov); add(camera.defocus_angle); add(camera.focus_distance);
+    add(camera.lookfrom.x); add(camera.lookfrom.y); add(camera.lookfrom.z);
+    add(camera.lookat.x); add(camera.lookat.y); add(camera.lookat.z);
+    add(camera.world_up.x); add(camera.world_up.y); add(camera.world_up.z);
+
+    // Integrator
+    add(camera.integrator); add(camera.packet_size); add(camera.wavefront_batch_size); add(camera.sort_rays);
+
+    // Sampling
+    add(camera.adaptive); add(camera.adaptive_threshold); add(camera.adaptive_min_samples);
+    add(camera.renders_in_passes() ? camera.samples_per_pass : 0);
+
+    return hash;
+}
@@ -4,10 +4,13 @@
 #include "hittable_list.hpp"
 #include "vec3.hpp"
 #include "color.hpp"
+#include "bvh_split.hpp"
 
 // Forward declarations
 class Mesh;
+class LinearBVH;
 struct Chrono;
+struct RayPacket;
 class Camera;
 class ImageWriter;
 
@@ -20,7 +23,7 @@ public:
 
     // Ray scattering settings
     int bounce_max_depth = 10;          // Maximum number of ray bounces into scene
-    double min_hit_distance = 0.001;    // Greatly solves shadow acne
+    real min_hit_distance = 0.001;      // Greatly solves shadow acne. Far from the origin, hit_epsilon raises it to the rounding error of the ray origin.
 
     // Antialiasing and noise settings
     int samples_per_pixel = 10;         // Count of random samples for each pixel
@@ -29,12 +32,22 @@ public:
     bool sky_blend = true;              // Enables a background sky gradient
     color background = SKY_BLUE;        // Sky gradient primary color
 
+    // Acceleration structure settings, also passed by the scenes to their meshes and nested BVHs
+    BVHSettings bvh_settings;
+
     // Hittable objects with PDF sampling distribution
     vector<shared_ptr<Hittable>> hittables_with_pdf;
 
+    // Frozen render tables, filled by freeze() once the scene is built. The render threads only read these
+    // raw pointers, while the shared_ptrs above keep the objects alive, so no reference count is touched per ray.
+    const Hittable* world = nullptr;    // Root of the scene BVH, flattened unless bvh_settings.flatten is off
+    vector<const Hittable*> lights;     // Hittables with PDF sampling distribution
+
     // Scene specs
     int bvh_depth = 0;
     int bvh_nodes = 0;
+    double bvh_sah_cost = 0;                // SAH cost of the main BVH
+    double bvh_alternative_sah_cost = 0;    // SAH cost of the main BVH built with the other split method, when bvh_settings.compare_splits is set
     int spheres = 0;
     int quads = 0;
     int triangles = 0;
@@ -48,6 +61,9 @@ public:
     shared_ptr<Chrono> build_chrono;
     shared_ptr<Chrono> bvh_chrono;
 
+    // Flattened scene BVH (null when the pointer tree is traced)
+    shared_ptr<LinearBVH> linear_bvh;
+
     // Mesh vector for log support
     vector<shared_ptr<Mesh>> meshes;
 
@@ -59,6 +75,9 @@ public:
     void end();
     void add(shared_ptr<Hittable> object) override;
     void build(Camera& camera, ImageWriter& image);
+    void freeze();
+    void intersect_packet(RayPacket& packet) const;    // Closest hit of every packet ray through the frozen world, left in packet.records
+    uint64_t config_hash(const Camera& camera, const ImageWriter& image) const; // Fingerprint of the settings that shape the rendered image
 };
 
 
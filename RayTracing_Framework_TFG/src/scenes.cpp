@@ -333,8 +333,8 @@ void scenes::cornell_box(Scene& scene, Camera& camera, ImageWriter& image)
     auto box2_model = Transform::transform_matrix(vec3(130, 0, 65), y_axis, -18.0);
 
     // Boxes
-    shared_ptr<Hittable> box1 = make_shared<Box>(point3(0, 0, 0), point3(165, 330, 165), white, box1_model);
-    shared_ptr<Hittable> box2 = make_shared<Box>(point3(0, 0, 0), point3(165, 165, 165), white, box2_model);
+    shared_ptr<Hittable> box1 = make_shared<Box>(point3(0, 0, 0), point3(165, 330, 165), white, box1_model, scene.bvh_settings);
+    shared_ptr<Hittable> box2 = make_shared<Box>(point3(0, 0, 0), point3(165, 165, 165), white, box2_model, scene.bvh_settings);
 
     // Transformations
     box1 = make_shared<transform>(box1, box1_model);
@@ -350,7 +350,7 @@ void scenes::cornell_box(Scene& scene, Camera& camera, ImageWriter& image)
     auto sphere1 = make_shared<Sphere>(point3(190, 90, 190), 90, glass, nullptr, true);
 
     // Mesh
-    auto mesh = load_obj("cube\\cube.obj");
+    auto mesh = load_obj("cube\\cube.obj", scene.bvh_settings);
 
     // Add primitives
     scene.add(quad1);
@@ -396,8 +396,8 @@ void scenes::cornell_smoke(Scene& scene, Camera& camera, ImageWriter& image)
     auto quad6 = make_shared<Quad>(point3(0, 0, 555), vec3(555, 0, 0), vec3(0, 555, 0), white);
 
     // Boxes
-    shared_ptr<Hittable> box1 = make_shared<Box>(point3(0, 0, 0), point3(165, 330, 165), white);
-    shared_ptr<Hittable> box2 = make_shared<Box>(point3(0, 0, 0), point3(165, 165, 165), white);
+    shared_ptr<Hittable> box1 = make_shared<Box>(point3(0, 0, 0), point3(165, 330, 165), white, nullptr, scene.bvh_settings);
+    shared_ptr<Hittable> box2 = make_shared<Box>(point3(0, 0, 0), point3(165, 165, 165), white, nullptr, scene.bvh_settings);
 
     // Transformations
     box1 = make_shared<rotate>(box1, y_axis, -15.0);
@@ -468,14 +468,14 @@ void scenes::book2_final_scene(Scene& scene, Camera& camera, ImageWriter& image)
             auto y1 = random_double(1, 101);
             auto z1 = z0 + w;
 
-            auto box = make_shared<Box>(point3(x0, y0, z0), point3(x1, y1, z1), ground);
+            auto box = make_shared<Box>(point3(x0, y0, z0), point3(x1, y1, z1), ground, nullptr, scene.bvh_settings);
             *scene.bvh_chrono += *box->bvh_chrono();
 
             boxes.add(box);
         }
     }
 
-    auto box_bvh_tree = make_shared<bvh_node>(boxes);
+    auto box_bvh_tree = make_shared<bvh_node>(boxes, scene.bvh_settings);
 
     // Light source
     auto quad1 = make_shared<Quad>(point3(123, 554, 147), vec3(300, 0, 0), vec3(0, 0, 265), light);
@@ -508,7 +508,7 @@ void scenes::book2_final_scene(Scene& scene, Camera& camera, ImageWriter& image)
         spheres.add(sphere);
     }
 
-    auto spheres_bvh_tree = make_shared<bvh_node>(spheres);
+    auto spheres_bvh_tree = make_shared<bvh_node>(spheres, scene.bvh_settings);
     transformed_spheres_bvh_tree = make_shared<rotate>(spheres_bvh_tree, y_axis, -15);
     transformed_spheres_bvh_tree = make_shared<translate>(transformed_spheres_bvh_tree, vec3(-100, 270, 395));
 
@@ -546,7 +546,7 @@ void scenes::obj_test(Scene& scene, Camera& camera, ImageWriter& image)
     scene.samples_per_pixel = 10;
 
     // Mesh
-    auto mesh = load_obj("cube\\cube.obj");
+    auto mesh = load_obj("cube\\cube.obj", scene.bvh_settings);
 
     // Add objects to scene
     if (mesh) scene.add(mesh);
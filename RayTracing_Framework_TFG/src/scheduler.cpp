@@ -0,0 +1,149 @@
+﻿// Headers
+#include "core.hpp"
+#include "scheduler.hpp"
+
+TileScheduler::TileScheduler(int width, int height, int tile_size, int threads)
+    : TileScheduler(Tile{ 0, 0, height, 0, width }, tile_size, threads) {}
+
+TileScheduler::TileScheduler(const Tile& region, int tile_size, int threads)
+{
+    this->threads = resolve_thread_count(threads);
+    tile_size = std::max(1, tile_size);
+
+    // Split the region into tiles (row-major order)
+    for (int row_start = region.row_start; row_start < region.row_end; row_start += tile_size)
+    {
+        for (int column_start = region.column_start; column_start < region.column_end; column_start += tile_size)
+        {
+            Tile tile;
+            tile.index = int(tiles.size());
+            tile.row_start = row_start;
+            tile.row_end = std::min(row_start + tile_size, region.row_end);
+            tile.column_start = column_start;
+            tile.column_end = std::min(column_start + tile_size, region.column_end);
+            tiles.push_back(tile);
+        }
+    }
+
+    // Never spawn more workers than tiles
+    this->threads = std::max(1, std::min(this->threads, int(tiles.size())));
+
+    for (int worker = 0; worker < this->threads; worker++)
+        queues.push_back(std::make_unique<WorkerQueue>());
+}
+
+void TileScheduler::run(const std::function<void(const Tile&, int)>& render_tile)
+{
+    distribute_tiles();
+    tiles_completed = 0;
+
+    auto worker_loop = [&](int worker_index)
+    {
+        int tile_index;
+
+        while (pop_tile(worker_index, tile_index) || steal_tile(worker_index, tile_index))
+        {
+            render_tile(tiles[tile_index], worker_index);
+
+            if (++tiles_completed == num_tiles())
+            {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                progress.notify_one();
+            }
+        }
+    };
+
+    // Launch workers
+    vector<std::thread> workers;
+    for (int worker = 0; worker < threads; worker++)
+        workers.emplace_back(worker_loop, worker);
+
+    // Progress info while the workers render. Waking up on completion keeps short runs (progressive passes) from idling.
+    int total_tiles = num_tiles();
+    std::unique_lock<std::mutex> lock(progress_mutex);
+    while (tiles_completed < total_tiles)
+    {
+        std::clog << "\rTiles remaining: " << (total_tiles - tiles_completed) << ' ' << std::flush;
+        progress.wait_for(lock, std::chrono::milliseconds(100), [&] { return tiles_completed >= total_tiles; });
+    }
+    lock.unlock();
+    std::clog << "\rTiles remaining: 0 " << std::flush;
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+int TileScheduler::num_threads() const
+{
+    return threads;
+}
+
+int TileScheduler::num_tiles() const
+{
+    return int(tiles.size());
+}
+
+const vector<Tile>& TileScheduler::get_tiles() const
+{
+    return tiles;
+}
+
+int TileScheduler::resolve_thread_count(int requested_threads)
+{
+    if (requested_threads > 0)
+        return requested_threads;
+
+    int hardware_threads = int(std::thread::hardware_concurrency());
+    return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+void TileScheduler::distribute_tiles()
+{
+    // Give each worker a contiguous block of tiles so neighbouring tiles stay on the same core
+    int total_tiles = num_tiles();
+
+    for (int worker = 0; worker < threads; worker++)
+    {
+        int first = int(int64_t(total_tiles) * worker / threads);
+        int last = int(int64_t(total_tiles) * (worker + 1) / threads);
+
+        auto& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tiles.clear();
+
+        for (int tile_index = first; tile_index < last; tile_index++)
+            queue.tiles.push_back(tile_index);
+    }
+}
+
+bool TileScheduler::pop_tile(int worker_index, int& tile_index)
+{
+    auto& queue = *queues[worker_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tiles.empty())
+        return false;
+
+    tile_index = queue.tiles.front();
+    queue.tiles.pop_front();
+    return true;
+}
+
+bool TileScheduler::steal_tile(int worker_index, int& tile_index)
+{
+    // Visit the other workers starting from the next one so thieves spread over different victims
+    for (int offset = 1; offset < threads; offset++)
+    {
+        auto& victim = *queues[(worker_index + offset) % threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tiles.empty())
+            continue;
+
+        tile_index = victim.tiles.back();
+        victim.tiles.pop_back();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+
+struct Tile
+{
+    int index;                          // Tile index in row-major tile order
+    int row_start, row_end;             // Pixel rows covered by the tile [row_start, row_end)
+    int column_start, column_end;       // Pixel columns covered by the tile [column_start, column_end)
+};
+
+class TileScheduler // Work-stealing scheduler that renders image tiles on a pool of worker threads
+{
+public:
+    TileScheduler(int width, int height, int tile_size, int threads);
+    TileScheduler(const Tile& region, int tile_size, int threads);  // Splits only the given pixel region
+
+    // Runs render_tile(tile, worker_index) for every tile and blocks until all of them are done.
+    // Each worker first drains its own contiguous block of tiles and then steals from the back of the other workers' queues.
+    void run(const std::function<void(const Tile&, int)>& render_tile);
+
+    int num_threads() const;
+    int num_tiles() const;
+    const vector<Tile>& get_tiles() const;
+
+    static int resolve_thread_count(int requested_threads); // Returns the number of hardware threads when requested_threads is not positive.
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<int> tiles;
+    };
+
+    int threads;
+    vector<Tile> tiles;
+    vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<int> tiles_completed = 0;
+    std::mutex progress_mutex;
+    std::condition_variable progress;   // Signalled when the last tile of a run completes
+
+    void distribute_tiles();
+    bool pop_tile(int worker_index, int& tile_index);
+    bool steal_tile(int worker_index, int& tile_index);
+};
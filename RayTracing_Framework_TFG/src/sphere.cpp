@@ -3,10 +3,11 @@
 #include "sphere.hpp"
 #include "aabb.hpp"
 #include "utilities.hpp"
+#include "ray_stats.hpp"
 #include "onb.hpp"
 #include "matrix.hpp"
 
-Sphere::Sphere(point3 static_center, const double radius, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model, bool pdf) : radius(std::fmax(0, radius)), material(material)
+Sphere::Sphere(point3 static_center, const real radius, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model, bool pdf) : radius(std::fmax(0, radius)), material(material)
 {
     type = SPHERE;
     this->model = model ? model : Hittable::model;
@@ -18,10 +19,10 @@ Sphere::Sphere(point3 static_center, const double radius, const shared_ptr<Mater
     center = motion_vector(origin, direction);
 
     vec3 radius_vector = vec3(radius, radius, radius);
-    bbox = make_shared<AABB>(static_center - radius_vector, static_center + radius_vector);
+    bbox = AABB(static_center - radius_vector, static_center + radius_vector);
 }
 
-Sphere::Sphere(point3 start_center, point3 end_center, const double radius, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model) : radius(std::fmax(0, radius)), material(material)
+Sphere::Sphere(point3 start_center, point3 end_center, const real radius, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model) : radius(std::fmax(0, radius)), material(material)
 {
     type = SPHERE;
     this->model = model ? model : Hittable::model;
@@ -34,16 +35,18 @@ Sphere::Sphere(point3 start_center, point3 end_center, const double radius, cons
     vec3 radius_vector = vec3(radius, radius, radius);
     AABB box1(center.at(0) - radius_vector, center.at(0) + radius_vector);
     AABB box2(center.at(1) - radius_vector, center.at(1) + radius_vector);
-    bbox = make_shared<AABB>(box1, box2);
+    bbox = AABB(box1, box2);
 }
 
-bool Sphere::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool Sphere::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
-    point3 current_center = center.at(r->time());
+    RayStats::local().primitives_tested++;
 
-    vec3 oc = current_center - r->origin();
-    auto a = r->direction().length_squared();
-    auto h = dot(r->direction(), oc); // h = -b/2
+    point3 current_center = center.at(r.time());
+
+    vec3 oc = current_center - r.origin();
+    auto a = r.direction().length_squared();
+    auto h = dot(r.direction(), oc); // h = -b/2
     auto c = oc.length_squared() - radius * radius;
 
     auto discriminant = h * h - a * c;
@@ -60,37 +63,35 @@ bool Sphere::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record
             return false;
     }
 
-    vec3 phit = r->at(root);
+    vec3 phit = r.at(root);
     vec3 outward_normal = (phit - current_center) / radius;
 
     // Hit record
-    auto sph_rec = make_shared<sphere_hit_record>();
-    sph_rec->t = root;
-    sph_rec->p = phit;
-    sph_rec->material = material;
-    sph_rec->determine_normal_direction(r->direction(), outward_normal);
-    sph_rec->texture_coordinates = get_sphere_uv(outward_normal);
-    sph_rec->type = type;
-
-    // Polymorphic assignment
-    rec = sph_rec;
+    rec.t = root;
+    rec.p = phit;
+    rec.material = material.get();
+    rec.determine_normal_direction(r.direction(), outward_normal);
+    rec.texture_coordinates = get_sphere_uv(outward_normal);
+    rec.type = type;
 
     return true;
 }
 
-shared_ptr<AABB> Sphere::bounding_box() const
+const AABB& Sphere::bounding_box() const
 {
     return bbox;
 }
 
-double Sphere::pdf_value(const point3& origin, const vec3& direction) const
+double Sphere::pdf_value(const point3& origin, const vec3& direction, Sampler& sampler) const
 {
     // This method only works for stationary spheres.
 
-    shared_ptr<hit_record> rec;
-    auto ray = make_shared<Ray>(origin, direction);
+    hit_record rec;
+    auto ray = Ray(origin, direction);
+
+    RayStats::local().count_ray(SHADOW_RAY, sampler.bounce());
 
-    if (!this->hit(ray, Interval(0.001, infinity), rec))
+    if (!this->hit(ray, Interval(hit_epsilon(ray, 0.001), infinity), rec, sampler))
         return 0;
 
     auto dist_squared = (center.at(0) - origin).length_squared();
@@ -100,12 +101,12 @@ double Sphere::pdf_value(const point3& origin, const vec3& direction) const
     return  1 / solid_angle;
 }
 
-vec3 Sphere::random_scattering_ray(const point3& origin) const
+vec3 Sphere::random_scattering_ray(const point3& origin, Sampler& sampler) const
 {
     vec3 direction = center.at(0) - origin;
     auto distance_squared = direction.length_squared();
     ONB uvw(direction);
-    return uvw.transform(sphere_front_face_random(radius, distance_squared));
+    return uvw.transform(sphere_front_face_random(radius, distance_squared, sampler));
 }
 
 pair<double, double> Sphere::get_sphere_uv(const point3& p)
@@ -120,10 +121,10 @@ pair<double, double> Sphere::get_sphere_uv(const point3& p)
     return make_pair(phi / (2 * pi), theta / pi);
 }
 
-vec3 Sphere::sphere_front_face_random(double radius, double distance_squared)
+vec3 Sphere::sphere_front_face_random(double radius, double distance_squared, Sampler& sampler)
 {
-    auto r1 = random_double();
-    auto r2 = random_double();
+    auto r1 = sampler.random_double();
+    auto r2 = sampler.random_double();
     auto phi = 2 * pi * r1;
 
     auto z = 1 + r2 * (std::sqrt(1 - radius * radius / distance_squared) - 1);
@@ -8,7 +8,9 @@
 #include <comdef.h>
 #include <tlhelp32.h>
 #include <wbemidl.h>
+#include <psapi.h>
 #pragma comment(lib, "wbemuuid.lib")
+#pragma comment(lib, "psapi.lib")
 
 string SystemInfo::GetCPUModel()
 {
@@ -129,6 +131,16 @@ int SystemInfo::getActiveThreads()
     return threadCount;
 }
 
+uint64_t SystemInfo::peak_resident_memory()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return counters.PeakWorkingSetSize;
+}
+
 // Static members
 const string SystemInfo::platform = getPlatform();
-const int SystemInfo::cpu_threads = getActiveThreads();
\ No newline at end of file
+int SystemInfo::cpu_threads = getActiveThreads();
\ No newline at end of file
@@ -7,7 +7,9 @@ struct SystemInfo
 {
 public:
     static const string platform;
-    static const int cpu_threads;
+    static int cpu_threads;         // Threads used by the last render
+
+    static uint64_t peak_resident_memory(); // Peak working set of the process in bytes
 
 private:
     static string GetCPUModel();
@@ -2,6 +2,7 @@
 #include "core.hpp"
 #include "triangle.hpp"
 #include "utilities.hpp"
+#include "ray_stats.hpp"
 #include "ray.hpp"
 #include "interval.hpp"
 #include "aabb.hpp"
@@ -24,14 +25,16 @@ Triangle::Triangle(vertex A, vertex B, vertex C, const shared_ptr<Material>& mat
     // if (normal.length() < kEpsilon)
         // throw std::runtime_error("Triangle vertices are colinear");
 
-    bbox = make_shared<AABB>(A.position, B.position, C.position);
+    bbox = AABB(A.position, B.position, C.position);
 }
 
-bool Triangle::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const
+bool Triangle::hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const
 {
+    RayStats::local().primitives_tested++;
+
     // Calculate P vector and determinant
-    vec3 P = cross(r->direction(), AC);
-    double det = dot(AB, P);
+    vec3 P = cross(r.direction(), AC);
+    real det = dot(AB, P);
 
     // If the determinant is negative, the triangle is back-facing.
     // If the determinant is close to 0, the ray misses the triangle (parallel).
@@ -45,39 +48,35 @@ bool Triangle::hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_reco
     }
 
     // Invert determinant
-    double invDet = 1 / det;
+    real invDet = 1 / det;
 
     // Get barycentric cordinate u and check if the ray hits inside the u-edge
-    vec3 T = r->origin() - A.position;
-    double u = dot(T, P) * invDet;
+    vec3 T = r.origin() - A.position;
+    real u = dot(T, P) * invDet;
     if (u < 0 || u > 1) return false;
 
     // Get barycentric cordinate v and check if the ray hits inside the v-edge
     vec3 Q = cross(T, AB);
-    double v = dot(r->direction(), Q) * invDet;
+    real v = dot(r.direction(), Q) * invDet;
     if (v < 0 || u + v > 1) return false;
 
     // Get barycentric cordinate w
-    double w = 1 - u - v;
+    real w = 1 - u - v;
 
     // Get value t of the ray
-    double t = dot(AC, Q) * invDet;
+    real t = dot(AC, Q) * invDet;
 
     // Check if the intersection is within the valid range (check if the ray hits the triangle from behind or front)
     if (!ray_t.surrounds(t)) return false;
 
     // Hit record
-    auto tri_rec = make_shared<triangle_hit_record>();
-    tri_rec->t = t;
-    tri_rec->p = r->at(t);
-    tri_rec->material = material;
-    tri_rec->texture_coordinates = interpolate_texture_coordinates(u, v, w);
-    tri_rec->type = type;
-    tri_rec->bc = { u, v, w };
-    tri_rec->determine_normal_direction(r->direction(), N);
-
-    // Polymorphic assignment
-    rec = tri_rec;
+    rec.t = t;
+    rec.p = r.at(t);
+    rec.material = material.get();
+    rec.texture_coordinates = interpolate_texture_coordinates(u, v, w);
+    rec.type = type;
+    rec.bc = { u, v, w };
+    rec.determine_normal_direction(r.direction(), N);
 
     return true;
 }
@@ -92,30 +91,32 @@ bool Triangle::has_vertex_normals() const
     return A.normal.has_value() && B.normal.has_value() && C.normal.has_value();
 }
 
-shared_ptr<AABB> Triangle::bounding_box() const
+const AABB& Triangle::bounding_box() const
 {
     return bbox;
 }
 
-double Triangle::pdf_value(const point3& hit_point, const vec3& scattering_direction) const
+double Triangle::pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const
 {
-    shared_ptr<hit_record> rec;
-    auto ray = make_shared<Ray>(hit_point, scattering_direction);
+    hit_record rec;
+    auto ray = Ray(hit_point, scattering_direction);
+
+    RayStats::local().count_ray(SHADOW_RAY, sampler.bounce());
 
-    if (!this->hit(ray, Interval(0.001, infinity), rec))
+    if (!this->hit(ray, Interval(hit_epsilon(ray, 0.001), infinity), rec, sampler))
         return 0;
 
-    auto distance_squared = rec->t * rec->t * scattering_direction.length_squared(); // light_hit_point - origin = t * direction
-    auto cosine = fabs(dot(scattering_direction, rec->normal) / scattering_direction.length()); // scattering direction is not normalized
+    auto distance_squared = rec.t * rec.t * scattering_direction.length_squared(); // light_hit_point - origin = t * direction
+    auto cosine = fabs(dot(scattering_direction, rec.normal) / scattering_direction.length()); // scattering direction is not normalized
 
     return distance_squared / (cosine * area);
 }
 
-vec3 Triangle::random_scattering_ray(const point3& hit_point) const
+vec3 Triangle::random_scattering_ray(const point3& hit_point, Sampler& sampler) const
 {
     // Generate random barycentric coordinates
-    auto r1 = random_double();
-    auto r2 = random_double();
+    auto r1 = sampler.random_double();
+    auto r2 = sampler.random_double();
 
     // Convert to barycentric coordinates
     auto sqrt_r1 = sqrt(r1);
@@ -23,18 +23,18 @@ public:
 
     Triangle(vertex A, vertex B, vertex C, const shared_ptr<Material>& material, const shared_ptr<Matrix44>& model = nullptr);
 
-    bool hit(const shared_ptr<Ray>& r, Interval ray_t, shared_ptr<hit_record>& rec) const override;
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec, Sampler& sampler) const override;
     bool has_vertex_colors() const;
     bool has_vertex_normals() const;
-    shared_ptr<AABB> bounding_box() const override;
-    double pdf_value(const point3& hit_point, const vec3& scattering_direction) const override;
-    vec3 random_scattering_ray(const point3& hit_point) const override; // https://stackoverflow.com/questions/19654251/random-point-inside-triangle-inside-java
+    const AABB& bounding_box() const override;
+    double pdf_value(const point3& hit_point, const vec3& scattering_direction, Sampler& sampler) const override;
+    vec3 random_scattering_ray(const point3& hit_point, Sampler& sampler) const override; // https://stackoverflow.com/questions/19654251/random-point-inside-triangle-inside-java
 
 private:
     vec3 AB, AC, N;
     double area;
     shared_ptr<Material> material;
-    shared_ptr<AABB> bbox;
+    AABB bbox;
 
     pair<double, double> interpolate_texture_coordinates(double u, double v, double w) const;
 };
@@ -0,0 +1,407 @@
+﻿// Headers
+#include "core.hpp"
+#include "triangle_mesh.hpp"
+#include "triangle.hpp"
+#include "hittable.hpp"
+#include "utilities.hpp"
+#include "ray.hpp"
+#include "ray_stats.hpp"
+#include "interval.hpp"
+
+TriangleMesh::TriangleMesh() {}
+
+void TriangleMesh::build_bvh(const BVHSettings& settings)
+{
+    nodes.clear();
+    wide_nodes = WideBVH();
+    bbox = AABB::empty;
+    depth = 0;
+    bvh_settings = settings;
+
+    size_t triangles = num_triangles();
+    if (triangles == 0)
+        return;
+
+    if (triangles > std::numeric_limits<uint32_t>::max() / 3)
+    {
+        string error = Logger::error("TRIANGLE_MESH", "The mesh has too many triangles for a 32-bit index buffer.");
+        throw std::length_error(error);
+    }
+
+    // Bounding boxes of the triangles, only needed while building
+    int threads = settings.build_thread_count();
+    vector<AABB> triangle_bboxes(triangles);
+    vector<uint32_t> order(triangles);
+    vector<AABB> chunk_bboxes(threads, AABB::empty);
+
+    parallel_chunks(0, triangles, threads, [&](size_t chunk_start, size_t chunk_end, int chunk)
+    {
+        for (size_t triangle = chunk_start; triangle < chunk_end; triangle++)
+        {
+            const uint32_t* vertex = &indices[3 * triangle];
+            triangle_bboxes[triangle] = AABB(positions[vertex[0]], positions[vertex[1]], positions[vertex[2]]);
+            order[triangle] = uint32_t(triangle);
+            chunk_bboxes[chunk] = AABB(chunk_bboxes[chunk], triangle_bboxes[triangle]);
+        }
+    });
+
+    for (const auto& chunk_bbox : chunk_bboxes)
+        bbox = AABB(bbox, chunk_bbox);
+
+    // The LBVH sorts the triangles along a Morton curve once, every node then splits its run of the sorted codes
+    MortonOrder morton;
+    if (settings.split == LBVH_SPLIT)
+        morton = morton_sort(order, 0, triangles, settings, [&](uint32_t triangle) -> const AABB& { return triangle_bboxes[triangle]; }, threads);
+
+    nodes.reserve(2 * (triangles / settings.leaf_size() + 1));
+    depth = build_node(nodes, order, triangle_bboxes, morton, 0, triangles, bbox, 0, threads);
+    nodes.shrink_to_fit();
+
+    if (settings.node_width() > 2)
+        wide_nodes.build(nodes, settings.node_width(), settings.simd);
+
+    // Store the triangles in build order, so each leaf reads one contiguous run of the index buffer
+    vector<uint32_t> sorted_indices(indices.size());
+    vector<uint16_t> sorted_material_ids(material_ids.size());
+
+    for (size_t i = 0; i < triangles; i++)
+    {
+        sorted_indices[3 * i + 0] = indices[3 * size_t(order[i]) + 0];
+        sorted_indices[3 * i + 1] = indices[3 * size_t(order[i]) + 1];
+        sorted_indices[3 * i + 2] = indices[3 * size_t(order[i]) + 2];
+        sorted_material_ids[i] = material_ids[order[i]];
+    }
+
+    indices = std::move(sorted_indices);
+    material_ids = std::move(sorted_material_ids);
+}
+
+int TriangleMesh::build_node(vector<linear_bvh_node>& subtree, vector<uint32_t>& order, const vector<AABB>& triangle_bboxes, const MortonOrder& morton, size_t start, size_t end, const AABB& node_bbox, int node_depth, int threads)
+{
+    // Nodes are appended in depth-first order, so the first child of an interior node directly follows it
+    uint32_t node_index = uint32_t(subtree.size());
+    subtree.emplace_back();
+    subtree[node_index].set_bounds(node_bbox);
+    subtree[node_index].axis = 0;
+    subtree[node_index].padding = 0;
+
+    size_t triangle_span = end - start;
+
+    auto box_of = [&](uint32_t triangle) -> const AABB& { return triangle_bboxes[triangle]; };
+    size_t mid = end;
+
+    if (bvh_settings.split == SAH_SPLIT && node_depth < bvh_median_depth)
+        mid = sah_partition(order, start, end, node_bbox, bvh_settings, box_of, threads);
+    else if (bvh_settings.split == LBVH_SPLIT && node_depth < bvh_median_depth)
+        mid = morton.split(start, end, bvh_settings);
+    else if (triangle_span > size_t(bvh_settings.leaf_size()))
+        mid = median_partition(order, start, end, node_bbox, box_of);
+
+    if (mid == end)
+    {
+        subtree[node_index].offset = uint32_t(start);
+        subtree[node_index].count = uint16_t(triangle_span);
+        return node_depth;
+    }
+
+    // Bounding boxes of the two halves, handed down to the children
+    AABB first_bbox = AABB::empty, second_bbox = AABB::empty;
+    for (size_t i = start; i < mid; i++)
+        first_bbox = AABB(first_bbox, triangle_bboxes[order[i]]);
+    for (size_t i = mid; i < end; i++)
+        second_bbox = AABB(second_bbox, triangle_bboxes[order[i]]);
+
+    // The half lying lower along the split axis is emitted first, so the traversal can pick the near child from the direction sign.
+    // Only the nodes are reordered: both halves keep their place in order, which the Morton codes follow.
+    uint8_t axis = linear_bvh_node::split_axis(first_bbox, second_bbox);
+
+    size_t first_start = start, first_end = mid;
+    size_t second_start = mid, second_end = end;
+
+    if (first_bbox.centroid()[axis] > second_bbox.centroid()[axis])
+    {
+        std::swap(first_start, second_start);
+        std::swap(first_end, second_end);
+        std::swap(first_bbox, second_bbox);
+    }
+
+    int first_depth, second_depth;
+    uint32_t second_index;
+
+    if (threads > 1 && triangle_span >= bvh_parallel_min_span)
+    {
+        // The second half is built into a node array of its own on another thread, which takes half of the thread
+        // budget along, and is then appended behind the first half with its child indices shifted
+        vector<linear_bvh_node> second_subtree;
+        int second_threads = threads / 2;
+
+        std::thread second_builder([&]
+        {
+            second_subtree.reserve(2 * ((second_end - second_start) / bvh_settings.leaf_size() + 1));
+            second_depth = build_node(second_subtree, order, triangle_bboxes, morton, second_start, second_end, second_bbox, node_depth + 1, second_threads);
+        });
+
+        first_depth = build_node(subtree, order, triangle_bboxes, morton, first_start, first_end, first_bbox, node_depth + 1, threads - second_threads);
+        second_builder.join();
+
+        second_index = uint32_t(subtree.size());
+
+        for (linear_bvh_node node : second_subtree)
+        {
+            if (node.count == 0)
+                node.offset += second_index;
+
+            subtree.push_back(node);
+        }
+    }
+    else
+    {
+        first_depth = build_node(subtree, order, triangle_bboxes, morton, first_start, first_end, first_bbox, node_depth + 1, 1);
+        second_index = uint32_t(subtree.size());
+        second_depth = build_node(subtree, order, triangle_bboxes, morton, second_start, second_end, second_bbox, node_depth + 1, 1);
+    }
+
+    subtree[node_index].offset = second_index;
+    subtree[node_index].count = 0;
+    subtree[node_index].axis = axis;
+
+    return std::max(first_depth, second_depth);
+}
+
+bool TriangleMesh::hit(const Ray& r, Interval ray_t, hit_record& rec) const
+{
+    if (nodes.empty())
+        return false;
+
+    if (!wide_nodes.empty())
+    {
+        return wide_nodes.hit(r, ray_t, [&](uint32_t first, uint32_t count, Interval& interval)
+        {
+            bool hit_anything = false;
+
+            for (uint32_t triangle = first; triangle < first + count; triangle++)
+            {
+                if (hit_triangle(triangle, r, interval, rec))
+                {
+                    hit_anything = true;
+                    interval.max = rec.t;
+                }
+            }
+
+            return hit_anything;
+        });
+    }
+
+    RayStats& stats = RayStats::local();
+
+    const point3& origin = r.origin();
+    const vec3& direction = r.direction();
+    vec3 inverse_direction(1 / direction.x, 1 / direction.y, 1 / direction.z);
+    bool direction_negative[3] = { direction.x < 0, direction.y < 0, direction.z < 0 };
+
+    // Far children waiting to be visited. The build bounds the depth of the tree by the stack size.
+    uint32_t stack[linear_bvh_stack_size];
+    int stack_size = 0;
+    uint32_t node_index = 0;
+    bool hit_anything = false;
+
+    while (true)
+    {
+        const linear_bvh_node& node = nodes[node_index];
+        stats.bvh_nodes_visited++;
+
+        // The box test uses the closest hit so far, which culls far children behind it
+        if (node.hit(origin, inverse_direction, ray_t.min, ray_t.max))
+        {
+            if (node.count == 0)
+            {
+                if (direction_negative[node.axis])
+                {
+                    stack[stack_size++] = node_index + 1;
+                    node_index = node.offset;
+                }
+                else
+                {
+                    stack[stack_size++] = node.offset;
+                    node_index++;
+                }
+
+                continue;
+            }
+
+            for (uint32_t triangle = node.offset; triangle < node.offset + node.count; triangle++)
+            {
+                if (hit_triangle(triangle, r, ray_t, rec))
+                {
+                    hit_anything = true;
+                    ray_t.max = rec.t;
+                }
+            }
+        }
+
+        if (stack_size == 0)
+            break;
+
+        node_index = stack[--stack_size];
+    }
+
+    return hit_anything;
+}
+
+const AABB& TriangleMesh::bounding_box() const
+{
+    return bbox;
+}
+
+size_t TriangleMesh::num_triangles() const
+{
+    return indices.size() / 3;
+}
+
+size_t TriangleMesh::num_vertices() const
+{
+    return positions.size();
+}
+
+int TriangleMesh::bvh_depth() const
+{
+    return depth;
+}
+
+size_t TriangleMesh::bvh_nodes() const
+{
+    return nodes.size();
+}
+
+const WideBVH& TriangleMesh::wide_bvh() const
+{
+    return wide_nodes;
+}
+
+const BVHSettings& TriangleMesh::get_bvh_settings() const
+{
+    return bvh_settings;
+}
+
+double TriangleMesh::bvh_sah_cost() const
+{
+    return nodes.empty() ? 0.0 : node_sah_cost(0);
+}
+
+double TriangleMesh::node_sah_cost(uint32_t node_index) const
+{
+    const linear_bvh_node& node = nodes[node_index];
+
+    if (node.count > 0)
+        return bvh_settings.traversal_cost + bvh_settings.intersection_cost * node.count;
+
+    // Each child is entered with the probability that a ray crossing this box also crosses the child box
+    double area = node.bounds().surface_area();
+    double cost = bvh_settings.traversal_cost;
+
+    for (uint32_t child : { node_index + 1, node.offset })
+    {
+        double probability = area > 0 ? nodes[child].bounds().surface_area() / area : 1.0;
+        cost += probability * node_sah_cost(child);
+    }
+
+    return cost;
+}
+
+size_t TriangleMesh::vertex_bytes() const
+{
+    return positions.capacity() * sizeof(point3) + normals.capacity() * sizeof(vec3)
+        + uvs.capacity() * sizeof(pair<double, double>) + colors.capacity() * sizeof(color);
+}
+
+size_t TriangleMesh::index_bytes() const
+{
+    return indices.capacity() * sizeof(uint32_t) + material_ids.capacity() * sizeof(uint16_t);
+}
+
+size_t TriangleMesh::bvh_bytes() const
+{
+    return nodes.capacity() * sizeof(linear_bvh_node) + wide_nodes.memory_bytes();
+}
+
+bool TriangleMesh::hit_triangle(uint32_t triangle, const Ray& r, const Interval& ray_t, hit_record& rec) const
+{
+    RayStats::local().primitives_tested++;
+
+    // Same Moller-Trumbore test as Triangle::hit, with the edges fetched through the index buffer
+    const uint32_t* vertex = &indices[3 * size_t(triangle)];
+    const point3& A = positions[vertex[0]];
+    vec3 AB = positions[vertex[1]] - A;
+    vec3 AC = positions[vertex[2]] - A;
+
+    // Calculate P vector and determinant
+    vec3 P = cross(r.direction(), AC);
+    real det = dot(AB, P);
+
+    // If the determinant is negative, the triangle is back-facing.
+    // If the determinant is close to 0, the ray misses the triangle (parallel).
+    if (CULLING)
+    {
+        if (det < kEpsilon) return false;
+    }
+    else
+    {
+        if (fabs(det) < kEpsilon) return false;
+    }
+
+    // Invert determinant
+    real invDet = 1 / det;
+
+    // Get barycentric cordinate u and check if the ray hits inside the u-edge
+    vec3 T = r.origin() - A;
+    real u = dot(T, P) * invDet;
+    if (u < 0 || u > 1) return false;
+
+    // Get barycentric cordinate v and check if the ray hits inside the v-edge
+    vec3 Q = cross(T, AB);
+    real v = dot(r.direction(), Q) * invDet;
+    if (v < 0 || u + v > 1) return false;
+
+    // Get barycentric cordinate w
+    real w = 1 - u - v;
+
+    // Get value t of the ray
+    real t = dot(AC, Q) * invDet;
+
+    // Check if the intersection is within the valid range (check if the ray hits the triangle from behind or front)
+    if (!ray_t.surrounds(t)) return false;
+
+    // Geometric normal, only computed for accepted hits
+    vec3 normal = cross(AB, AC);
+    vec3 N = normal / normal.length();
+
+    // Hit record
+    rec.t = t;
+    rec.p = r.at(t);
+    rec.material = materials[material_ids[triangle]].get();
+    rec.texture_coordinates = interpolate_texture_coordinates(triangle, u, v, w);
+    rec.type = TRIANGLE;
+    rec.bc = { u, v, w };
+    rec.determine_normal_direction(r.direction(), N);
+
+    return true;
+}
+
+pair<double, double> TriangleMesh::interpolate_texture_coordinates(uint32_t triangle, double u, double v, double w) const
+{
+    // Meshes without texture coordinates map every point to (0,0)
+    if (uvs.empty())
+        return { 0.0, 0.0 };
+
+    // Retrieve the UVs from the vertices
+    const uint32_t* vertex = &indices[3 * size_t(triangle)];
+    auto [uA, vA] = uvs[vertex[0]];
+    auto [uB, vB] = uvs[vertex[1]];
+    auto [uC, vC] = uvs[vertex[2]];
+
+    // Interpolate UV coordinates using barycentric coordinates
+    double u_interp = w * uA + u * uB + v * uC;
+    double v_interp = w * vA + u * vB + v * vC;
+
+    return { u_interp, v_interp };
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "vec3.hpp"
+#include "aabb.hpp"
+#include "bvh_split.hpp"
+#include "linear_bvh.hpp"
+#include "wide_bvh.hpp"
+
+// Forward declarations
+class Ray;
+class Interval;
+class hit_record;
+class Material;
+
+// Macros
+
+class TriangleMesh // Indexed triangle storage: shared vertex attribute buffers, a 32-bit index buffer and one material id per triangle
+{
+public:
+    // Vertex attributes, one entry per unique vertex (the optional buffers are either empty or as long as positions)
+    vector<point3> positions;
+    vector<vec3> normals;
+    vector<pair<double, double>> uvs;
+    vector<color> colors;
+
+    // Triangles
+    vector<uint32_t> indices;                   // Three vertex indices per triangle
+    vector<uint16_t> material_ids;              // Index into materials for every triangle
+    vector<shared_ptr<Material>> materials;
+
+    TriangleMesh();
+
+    void build_bvh(const BVHSettings& settings = BVHSettings());   // Builds the mesh BVH on settings.build_thread_count() threads and reorders the triangles so that every leaf references a contiguous range
+    bool hit(const Ray& r, Interval ray_t, hit_record& rec) const;
+    const AABB& bounding_box() const;
+
+    size_t num_triangles() const;
+    size_t num_vertices() const;
+    int bvh_depth() const;
+    size_t bvh_nodes() const;
+    const WideBVH& wide_bvh() const;
+    double bvh_sah_cost() const;    // Expected traversal and intersection cost of a ray entering the mesh bounds
+    const BVHSettings& get_bvh_settings() const;   // Settings of the last build_bvh
+
+    // Memory footprint
+    size_t vertex_bytes() const;    // Shared vertex attribute buffers
+    size_t index_bytes() const;     // Index buffer and material ids
+    size_t bvh_bytes() const;       // Mesh BVH nodes, binary and wide
+
+private:
+    vector<linear_bvh_node> nodes;
+    WideBVH wide_nodes;     // Collapsed copy of nodes that the rays trace instead, unless the node width is 2
+    AABB bbox;      // Exact bounds of the mesh, the root node only keeps them in single precision
+    int depth = 0;
+    BVHSettings bvh_settings;
+
+    bool hit_triangle(uint32_t triangle, const Ray& r, const Interval& ray_t, hit_record& rec) const;
+    int build_node(vector<linear_bvh_node>& subtree, vector<uint32_t>& order, const vector<AABB>& triangle_bboxes, const MortonOrder& morton, size_t start, size_t end, const AABB& node_bbox, int node_depth, int threads);
+    double node_sah_cost(uint32_t node_index) const;
+    pair<double, double> interpolate_texture_coordinates(uint32_t triangle, double u, double v, double w) const;
+};
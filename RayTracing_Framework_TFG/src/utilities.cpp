@@ -79,8 +79,11 @@ file_size get_file_size(const string& file_path)
         return { 0.0, "B" };
     }
 
-    const uintmax_t bytes = fs::file_size(file_path);
+    return format_bytes(fs::file_size(file_path));
+}
 
+file_size format_bytes(uintmax_t bytes)
+{
     constexpr double kb_factor = 1024.0;
     constexpr double mb_factor = kb_factor * 1024.0;
     constexpr double gb_factor = mb_factor * 1024.0;
@@ -135,5 +138,93 @@ string trim_trailing_zeros(const double number, const bool remove_point)
     return str_number;
 }
 
+// ************** HASH UTILITIES ************** //
+
+uint64_t fnv1a_hash(const void* data, size_t size, uint64_t hash)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// ************** SORTING UTILITIES ************** //
+
+static uint32_t expand_bits(uint32_t v)
+{
+    // Spread the lower 10 bits so that two zero bits separate each of them
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+uint32_t morton_code(double x, double y, double z)
+{
+    auto quantize = [](double value) { return uint32_t(std::clamp(value * 1024.0, 0.0, 1023.0)); };
+
+    return (expand_bits(quantize(x)) << 2) | (expand_bits(quantize(y)) << 1) | expand_bits(quantize(z));
+}
+
+static uint64_t expand_bits_63(uint64_t v)
+{
+    // Spread the lower 21 bits so that two zero bits separate each of them
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x1F00000000FFFFull;
+    v = (v | v << 16) & 0x1F0000FF0000FFull;
+    v = (v | v << 8) & 0x100F00F00F00F00Full;
+    v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+
+uint64_t morton_code_63(double x, double y, double z)
+{
+    auto quantize = [](double value) { return uint64_t(std::clamp(value * 2097152.0, 0.0, 2097151.0)); };
+
+    return (expand_bits_63(quantize(x)) << 2) | (expand_bits_63(quantize(y)) << 1) | expand_bits_63(quantize(z));
+}
+
+void radix_sort(vector<uint64_t>& keys, vector<int>& order, int key_bits)
+{
+    constexpr int digit_bits = 11;
+    constexpr int buckets = 1 << digit_bits;
+
+    size_t count = keys.size();
+    vector<uint64_t> sorted_keys(count);
+    vector<int> sorted_order(count);
+    vector<size_t> offsets(buckets);
 
+    for (int shift = 0; shift < key_bits; shift += digit_bits)
+    {
+        // Histogram of the current digit turned into bucket start offsets
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (auto key : keys)
+            offsets[(key >> shift) & (buckets - 1)]++;
 
+        size_t offset = 0;
+        for (auto& bucket : offsets)
+        {
+            size_t bucket_size = bucket;
+            bucket = offset;
+            offset += bucket_size;
+        }
+
+        // Stable scatter
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t destination = offsets[(keys[i] >> shift) & (buckets - 1)]++;
+            sorted_keys[destination] = keys[i];
+            sorted_order[destination] = order[i];
+        }
+
+        keys.swap(sorted_keys);
+        order.swap(sorted_order);
+    }
+}
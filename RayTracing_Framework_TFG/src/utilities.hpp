@@ -4,6 +4,7 @@
 #include "core.hpp"
 #include "vec3.hpp"
 #include "vec4.hpp"
+#include "sampler.hpp"
 
 // ************** TIMESTAMP UTILITIES ************** //
 
@@ -19,6 +20,7 @@ struct file_size
 };
 
 file_size get_file_size(const string& file_path);
+file_size format_bytes(uintmax_t bytes); // Expresses a byte count in the largest unit (B, KB, MB or GB) that keeps it above one
 
 // ************** STRING UTILITIES ************** //
 
@@ -26,6 +28,16 @@ string to_list(const vector<string>& vec);
 string trim(const string& str);
 string trim_trailing_zeros(const double number, const bool remove_point = true);
 
+// ************** HASH UTILITIES ************** //
+
+uint64_t fnv1a_hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull); // 64-bit FNV-1a hash of the bytes, continuing from hash
+
+// ************** SORTING UTILITIES ************** //
+
+uint32_t morton_code(double x, double y, double z);                 // 30-bit Morton code of a point with coordinates in [0,1]
+uint64_t morton_code_63(double x, double y, double z);              // 63-bit Morton code of a point with coordinates in [0,1]
+void radix_sort(vector<uint64_t>& keys, vector<int>& order, int key_bits); // Stable LSD radix sort of keys, applying the same permutation to order
+
 // ************** MATH UTILITIES ************** //
 
 constexpr double clamp(double value, double min, double max) 
@@ -39,26 +51,31 @@ constexpr double degrees_to_radians(double degrees)
     return degrees * pi / 180.0; 
 }
 
+// Scene construction randomness. Rendering code never calls these and draws from the Sampler it is handed instead.
+inline Sampler& scene_sampler()
+{
+    static thread_local Sampler sampler;
+    return sampler;
+}
+
 inline double random_double() // Returns a random real in [0,1).
 {
-    static std::uniform_real_distribution<double> distribution(0.0, 1.0);
-    static std::mt19937 generator;
-    return distribution(generator);
+    return scene_sampler().random_double();
 }
 
 inline double random_double(double min, double max) // Returns a random real in [min,max).
 {
-    return min + (max - min) * random_double();
+    return scene_sampler().random_double(min, max);
 }
 
 inline int random_int(int min, int max) // Returns a random integer in [min,max].
 {
-    return int(random_double(min, max + 1));
+    return scene_sampler().random_int(min, max);
 }
 
 // ************** VECTOR UTILITIES ************** //
 
-inline double dot(const vec3& u, const vec3& v)
+inline real dot(const vec3& u, const vec3& v)
 {
     return u.x * v.x + u.y * v.y + u.z * v.z;
 }
@@ -117,63 +134,63 @@ inline vec3 max_vector(const vec3& v1, const vec3& v2)
 
 // ************** SAMPLE UTILITIES ************** //
 
-inline vec3 sample_square() // Returns the vector to a random point in the [-.5,-.5]-[+.5,+.5] unit square.
+inline vec3 sample_square(Sampler& sampler) // Returns the vector to a random point in the [-.5,-.5]-[+.5,+.5] unit square.
 {
-    return vec3(random_double() - 0.5, random_double() - 0.5, 0);
+    return vec3(sampler.random_double() - 0.5, sampler.random_double() - 0.5, 0);
 }
 
-inline vec3 sample_square_stratified(int sample_row, int sample_column, double pixel_sample_sqrt_inv) // Returns the vector to a random point in the square sub-pixel specified by grid indices sample_row and sample_column, for an idealized unit square pixel [-.5,-.5] to [+.5,+.5].
+inline vec3 sample_square_stratified(int sample_row, int sample_column, double pixel_sample_sqrt_inv, Sampler& sampler) // Returns the vector to a random point in the square sub-pixel specified by grid indices sample_row and sample_column, for an idealized unit square pixel [-.5,-.5] to [+.5,+.5].
 {
-    auto px = ((sample_row + random_double()) * pixel_sample_sqrt_inv) - 0.5;
-    auto py = ((sample_column + random_double()) * pixel_sample_sqrt_inv) - 0.5;
+    auto px = ((sample_row + sampler.random_double()) * pixel_sample_sqrt_inv) - 0.5;
+    auto py = ((sample_column + sampler.random_double()) * pixel_sample_sqrt_inv) - 0.5;
 
     return vec3(px, py, 0);
 }
 
-inline vec3 random_in_unit_disk() // Returns a random point in the unit disk.
+inline vec3 random_in_unit_disk(Sampler& sampler) // Returns a random point in the unit disk.
 {
     while (true)
     {
-        auto p = vec3(random_double(-1, 1), random_double(-1, 1), 0);
+        auto p = vec3(sampler.random_double(-1, 1), sampler.random_double(-1, 1), 0);
         if (p.length_squared() < 1)
             return p;
     }
 }
 
-inline vec3 sample_disk(double radius) // Returns a random point in the disk centered at origin.
+inline vec3 sample_disk(double radius, Sampler& sampler) // Returns a random point in the disk centered at origin.
 {
-    return radius * random_in_unit_disk();
+    return radius * random_in_unit_disk(sampler);
 }
 
-inline point3 defocus_disk_sample(vec3 center, vec3 defocus_disk_u, vec3 defocus_disk_v) // Returns a random point in the defocus disk given.
+inline point3 defocus_disk_sample(vec3 center, vec3 defocus_disk_u, vec3 defocus_disk_v, Sampler& sampler) // Returns a random point in the defocus disk given.
 {
-    auto p = random_in_unit_disk();
+    auto p = random_in_unit_disk(sampler);
     return center + (p[0] * defocus_disk_u) + (p[1] * defocus_disk_v);
 }
 
-inline vec3 random_unit_vector()
+inline vec3 random_unit_vector(Sampler& sampler)
 {
     while (true)
     {
-        auto p = vec3::random(-1, 1);
+        auto p = vec3::random(-1, 1, sampler);
         auto lensq = p.length_squared();
         if (practically_zero < lensq && lensq <= 1.0)
             return p / sqrt(lensq);
     }
 }
 
-inline vec3 random_on_hemisphere(const vec3& normal)
+inline vec3 random_on_hemisphere(const vec3& normal, Sampler& sampler)
 {
-    vec3 unit_vector_on_sphere = random_unit_vector();
+    vec3 unit_vector_on_sphere = random_unit_vector(sampler);
 
     // If the vector is in the same hemisphere than the normal return it, otherwise return its opposite.
     return (dot(unit_vector_on_sphere, normal) > 0.0) ? unit_vector_on_sphere : -unit_vector_on_sphere;
 }
 
-inline vec3 random_cosine_hemisphere_direction()
+inline vec3 random_cosine_hemisphere_direction(Sampler& sampler)
 {
-    auto r1 = random_double();
-    auto r2 = random_double();
+    auto r1 = sampler.random_double();
+    auto r2 = sampler.random_double();
 
     auto phi = 2 * pi * r1;
     auto x = std::cos(phi) * std::sqrt(r2);
@@ -2,80 +2,222 @@
 
 // Headers
 #include "core.hpp"
-#include "vec.hpp"
 
 // Forward declarations
 class vec3;
 
-class vec4 : public vec
+class alignas(32) vec4 // Plain vector of four doubles aligned to 32 bytes, so one vec4 fills exactly one 256-bit SIMD register
 {
 public:
     double x, y, z, w;
 
     // Constructors
-    vec4();
-    vec4(int i);
-    vec4(double d);
-    vec4(double x, double y, double z, double w);
+    constexpr vec4();
+    constexpr vec4(int i);
+    constexpr vec4(double d);
+    constexpr vec4(double x, double y, double z, double w);
     vec4(const vec3& v, double w);
 
     // Operator overloads
-    vec4 operator-() const;
+    constexpr vec4 operator-() const;
     double operator[](int i) const;
     double& operator[](int i);
-    vec4& operator+=(double t);
-    vec4& operator-=(double t);
-    vec4& operator*=(double t);
-    vec4& operator/=(double t);
-    vec4& operator+=(const vec4& v);
-    vec4& operator-=(const vec4& v);
-    vec4& operator*=(const vec4& v);
-    vec4& operator/=(const vec4& v);
+    constexpr vec4& operator+=(double t);
+    constexpr vec4& operator-=(double t);
+    constexpr vec4& operator*=(double t);
+    constexpr vec4& operator/=(double t);
+    constexpr vec4& operator+=(const vec4& v);
+    constexpr vec4& operator-=(const vec4& v);
+    constexpr vec4& operator*=(const vec4& v);
+    constexpr vec4& operator/=(const vec4& v);
     friend std::ostream& operator<<(std::ostream& out, const vec4& v);
 
     // Length-related functions
-    double length() const override;
-    double length_squared() const override;
-    vec4& normalize() override;
-    bool near_zero() const override; // Return true if the vector is close to zero in all dimensions.
+    double length() const;
+    constexpr double length_squared() const;
+    vec4& normalize();
+    bool near_zero() const; // Return true if the vector is close to zero in all dimensions.
 
     // Static random vector generation
     static vec4 random();
     static vec4 random(double min, double max);
 };
 
+// Inline members, so the hot vector math needs no calls across translation units
+constexpr vec4::vec4() : x(0), y(0), z(0), w(0) {}
+
+constexpr vec4::vec4(int i) : x(static_cast<double>(i)), y(static_cast<double>(i)), z(static_cast<double>(i)), w(static_cast<double>(i)) {}
+
+constexpr vec4::vec4(double d) : x(d), y(d), z(d), w(d) {}
+
+constexpr vec4::vec4(double x, double y, double z, double w) : x(x), y(y), z(z), w(w) {}
+
+constexpr vec4 vec4::operator-() const
+{
+    return vec4(-x, -y, -z, -w);
+}
+
+inline double vec4::operator[](int i) const
+{
+    switch (i)
+    {
+    case 0:
+        return x;
+    case 1:
+        return y;
+    case 2:
+        return z;
+    case 3:
+        return w;
+    default:
+        string error = Logger::error("vec4", "Invalid operator access value!!!");
+        throw std::invalid_argument(error);
+    }
+}
+
+inline double& vec4::operator[](int i)
+{
+    switch (i)
+    {
+    case 0:
+        return x;
+    case 1:
+        return y;
+    case 2:
+        return z;
+    case 3:
+        return w;
+    default:
+        string error = Logger::error("vec4", "Invalid operator access value!!!");
+        throw std::invalid_argument(error);
+    }
+}
+
+constexpr vec4& vec4::operator+=(double t)
+{
+    x += t;
+    y += t;
+    z += t;
+    w += t;
+    return *this;
+}
+
+constexpr vec4& vec4::operator-=(double t)
+{
+    x -= t;
+    y -= t;
+    z -= t;
+    w -= t;
+    return *this;
+}
+
+constexpr vec4& vec4::operator*=(double t)
+{
+    x *= t;
+    y *= t;
+    z *= t;
+    w *= t;
+    return *this;
+}
+
+constexpr vec4& vec4::operator/=(double t)
+{
+    return *this *= 1 / t;
+}
+
+constexpr vec4& vec4::operator+=(const vec4& v)
+{
+    x += v.x;
+    y += v.y;
+    z += v.z;
+    w += v.w;
+    return *this;
+}
+
+constexpr vec4& vec4::operator-=(const vec4& v)
+{
+    x -= v.x;
+    y -= v.y;
+    z -= v.z;
+    w -= v.w;
+    return *this;
+}
+
+constexpr vec4& vec4::operator*=(const vec4& v)
+{
+    x *= v.x;
+    y *= v.y;
+    z *= v.z;
+    w *= v.w;
+    return *this;
+}
+
+constexpr vec4& vec4::operator/=(const vec4& v)
+{
+    x /= v.x;
+    y /= v.y;
+    z /= v.z;
+    w /= v.w;
+    return *this;
+}
+
+inline double vec4::length() const
+{
+    return std::sqrt(length_squared());
+}
+
+constexpr double vec4::length_squared() const
+{
+    return x * x + y * y + z * z + w * w;
+}
+
+inline vec4& vec4::normalize()
+{
+    double len = length();
+    if (len > 0)
+    {
+        *this /= len;
+    }
+    return *this;
+}
+
+inline bool vec4::near_zero() const
+{
+    return (std::fabs(x) < kEpsilon) && (std::fabs(y) < kEpsilon) && (std::fabs(z) < kEpsilon) && (std::fabs(w) < kEpsilon);
+}
+
 // vec4 operators overloads
-inline vec4 operator+(const vec4& u, const vec4& v)
+constexpr vec4 operator+(const vec4& u, const vec4& v)
 {
     return vec4(u.x + v.x, u.y + v.y, u.z + v.z, u.w + v.w);
 }
 
-inline vec4 operator-(const vec4& u, const vec4& v)
+constexpr vec4 operator-(const vec4& u, const vec4& v)
 {
     return vec4(u.x - v.x, u.y - v.y, u.z - v.z, u.w - v.w);
 }
 
-inline vec4 operator*(const vec4& u, const vec4& v)
+constexpr vec4 operator*(const vec4& u, const vec4& v)
 {
     return vec4(u.x * v.x, u.y * v.y, u.z * v.z, u.w * v.w);
 }
 
-inline vec4 operator*(double t, const vec4& v)
+constexpr vec4 operator*(double t, const vec4& v)
 {
     return vec4(t * v.x, t * v.y, t * v.z, t * v.w);
 }
 
-inline vec4 operator*(const vec4& v, double t)
+constexpr vec4 operator*(const vec4& v, double t)
 {
     return t * v;
 }
 
-inline vec4 operator/(const vec4& u, const vec4& v)
+constexpr vec4 operator/(const vec4& u, const vec4& v)
 {
     return vec4(u.x / v.x, u.y / v.y, u.z / v.z, u.w / v.w);
 }
 
-inline vec4 operator/(const vec4& v, double t)
+constexpr vec4 operator/(const vec4& v, double t)
 {
     return (1 / t) * v;
 }
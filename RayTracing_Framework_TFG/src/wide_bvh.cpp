@@ -0,0 +1,323 @@
+﻿// Headers
+#include "core.hpp"
+#include "wide_bvh.hpp"
+#include "cpu_features.hpp"
+#include "linear_bvh.hpp"
+
+// Platform Headers
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WIDE_BVH_X86
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions compiled for it, MSVC emits them anywhere
+#if defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+static float round_down(real x)
+{
+    float f = float(x);
+    return (real(f) > x) ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+}
+
+static float round_up(real x)
+{
+    float f = float(x);
+    return (real(f) < x) ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+}
+
+wide_bvh_ray::wide_bvh_ray(const Ray& r)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        real origin = r.origin()[axis];
+        real direction = r.direction()[axis];
+
+        // The sign bit picks the planes, so a -0 direction enters through the maximum plane just as its -infinity inverse expects
+        bool negative = std::signbit(direction);
+
+        inverse_direction[axis] = float(1 / direction);
+        near_plane[axis] = negative ? axis + 3 : axis;
+        far_plane[axis] = negative ? axis : axis + 3;
+        near_origin[axis] = negative ? round_down(origin) : round_up(origin);
+        far_origin[axis] = negative ? round_up(origin) : round_down(origin);
+    }
+}
+
+// Slab distances that are NaN come from a ray lying in a plane parallel to its direction. Every kernel keeps the
+// interval unchanged for them, which counts the box as hit along that axis.
+template <int width>
+static uint32_t test_children_scalar(const wide_bvh_node<width>& node, const wide_bvh_ray& ray, float t_min, float t_max, float* t_near)
+{
+    uint32_t mask = 0;
+
+    for (int slot = 0; slot < width; slot++)
+    {
+        float entry = t_min;
+        float exit = t_max;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t0 = (node.bounds[ray.near_plane[axis]][slot] - ray.near_origin[axis]) * ray.inverse_direction[axis];
+            float t1 = (node.bounds[ray.far_plane[axis]][slot] - ray.far_origin[axis]) * ray.inverse_direction[axis];
+
+            entry = (t0 > entry) ? t0 : entry;
+            exit = (t1 < exit) ? t1 : exit;
+        }
+
+        t_near[slot] = entry;
+
+        if (entry <= exit * wide_bvh_exit_scale)
+            mask |= 1u << slot;
+    }
+
+    return mask;
+}
+
+#ifdef WIDE_BVH_X86
+template <int width>
+static uint32_t test_children_sse(const wide_bvh_node<width>& node, const wide_bvh_ray& ray, float t_min, float t_max, float* t_near)
+{
+    uint32_t mask = 0;
+    __m128 exit_scale = _mm_set1_ps(wide_bvh_exit_scale);
+
+    for (int block = 0; block < width; block += 4)
+    {
+        __m128 entry = _mm_set1_ps(t_min);
+        __m128 exit = _mm_set1_ps(t_max);
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128 inverse_direction = _mm_set1_ps(ray.inverse_direction[axis]);
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&node.bounds[ray.near_plane[axis]][block]), _mm_set1_ps(ray.near_origin[axis])), inverse_direction);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&node.bounds[ray.far_plane[axis]][block]), _mm_set1_ps(ray.far_origin[axis])), inverse_direction);
+
+            // maxps and minps return their second operand when the first one is NaN
+            entry = _mm_max_ps(t0, entry);
+            exit = _mm_min_ps(t1, exit);
+        }
+
+        _mm_store_ps(t_near + block, entry);
+        mask |= uint32_t(_mm_movemask_ps(_mm_cmple_ps(entry, _mm_mul_ps(exit, exit_scale)))) << block;
+    }
+
+    return mask;
+}
+
+AVX2_FUNCTION static uint32_t test_children_avx2(const wide_bvh_node<8>& node, const wide_bvh_ray& ray, float t_min, float t_max, float* t_near)
+{
+    __m256 entry = _mm256_set1_ps(t_min);
+    __m256 exit = _mm256_set1_ps(t_max);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        __m256 inverse_direction = _mm256_set1_ps(ray.inverse_direction[axis]);
+        __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.near_plane[axis]]), _mm256_set1_ps(ray.near_origin[axis])), inverse_direction);
+        __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.far_plane[axis]]), _mm256_set1_ps(ray.far_origin[axis])), inverse_direction);
+
+        entry = _mm256_max_ps(t0, entry);
+        exit = _mm256_min_ps(t1, exit);
+    }
+
+    _mm256_store_ps(t_near, entry);
+    return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(entry, _mm256_mul_ps(exit, _mm256_set1_ps(wide_bvh_exit_scale)), _CMP_LE_OQ)));
+}
+#endif
+
+// Widest node test the build and the host CPU allow
+template <int width>
+static wide_bvh_node_test<width> select_node_test(bool simd, NODE_TEST& test)
+{
+#ifdef WIDE_BVH_X86
+    const CPUFeatures& cpu = CPUFeatures::host();
+
+    if constexpr (width == 8)
+    {
+        if (simd && cpu.avx2)
+        {
+            test = AVX2_NODE_TEST;
+            return test_children_avx2;
+        }
+    }
+
+    if (simd && cpu.sse2)
+    {
+        test = SSE_NODE_TEST;
+        return test_children_sse<width>;
+    }
+#endif
+
+    test = SCALAR_NODE_TEST;
+    return test_children_scalar<width>;
+}
+
+void WideBVH::build(const vector<linear_bvh_node>& binary_nodes, int width, bool simd)
+{
+    nodes4.clear();
+    nodes8.clear();
+    _depth = 0;
+
+    if (width != 4 && width != 8)
+    {
+        string error = Logger::error("WIDE_BVH", "Wide BVH nodes must have 4 or 8 children.");
+        throw std::invalid_argument(error);
+    }
+
+    _width = width;
+
+    if (width == 8)
+    {
+        test8 = select_node_test<8>(simd, test);
+
+        if (!binary_nodes.empty())
+            collapse(nodes8, binary_nodes, 0, 0);
+
+        nodes8.shrink_to_fit();
+    }
+    else
+    {
+        test4 = select_node_test<4>(simd, test);
+
+        if (!binary_nodes.empty())
+            collapse(nodes4, binary_nodes, 0, 0);
+
+        nodes4.shrink_to_fit();
+    }
+}
+
+template <int node_width>
+uint32_t WideBVH::collapse(vector<wide_bvh_node<node_width>>& nodes, const vector<linear_bvh_node>& binary_nodes, uint32_t binary_index, int node_depth)
+{
+    if (node_depth >= wide_bvh_max_depth)
+    {
+        string error = Logger::error("WIDE_BVH", "The BVH is too deep for the traversal stack of the wide tree.");
+        throw std::length_error(error);
+    }
+
+    uint32_t node_index = uint32_t(nodes.size());
+    nodes.emplace_back();
+    _depth = std::max(_depth, node_depth);
+
+    auto surface_area = [&](uint32_t index)
+    {
+        const linear_bvh_node& node = binary_nodes[index];
+        double x = double(node.bounds_max[0]) - node.bounds_min[0];
+        double y = double(node.bounds_max[1]) - node.bounds_min[1];
+        double z = double(node.bounds_max[2]) - node.bounds_min[2];
+        return 2 * (x * y + y * z + z * x);
+    };
+
+    // Open the binary subtree from its root, always replacing the interior child with the largest box by its two
+    // children, until the node is full or only leaves are left
+    uint32_t children[node_width];
+    int child_count = 0;
+    children[child_count++] = binary_index;
+
+    while (child_count < node_width)
+    {
+        int largest = -1;
+        double largest_area = -1;
+
+        for (int i = 0; i < child_count; i++)
+        {
+            if (binary_nodes[children[i]].count == 0 && surface_area(children[i]) > largest_area)
+            {
+                largest = i;
+                largest_area = surface_area(children[i]);
+            }
+        }
+
+        if (largest < 0)
+            break;
+
+        uint32_t opened = children[largest];
+        children[largest] = opened + 1;
+        children[child_count++] = binary_nodes[opened].offset;
+    }
+
+    for (int slot = 0; slot < node_width; slot++)
+    {
+        if (slot >= child_count)
+        {
+            wide_bvh_node<node_width>& node = nodes[node_index];
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                node.bounds[axis][slot] = std::numeric_limits<float>::infinity();
+                node.bounds[axis + 3][slot] = -std::numeric_limits<float>::infinity();
+            }
+
+            node.child[slot] = 0;
+            node.count[slot] = 0;
+            continue;
+        }
+
+        // Collapse interior children first, the recursion may move the node array
+        const linear_bvh_node& binary_child = binary_nodes[children[slot]];
+        uint32_t child = (binary_child.count > 0) ? binary_child.offset : collapse(nodes, binary_nodes, children[slot], node_depth + 1);
+
+        wide_bvh_node<node_width>& node = nodes[node_index];
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            node.bounds[axis][slot] = binary_child.bounds_min[axis];
+            node.bounds[axis + 3][slot] = binary_child.bounds_max[axis];
+        }
+
+        node.child[slot] = child;
+        node.count[slot] = binary_child.count;
+    }
+
+    return node_index;
+}
+
+bool WideBVH::empty() const
+{
+    return nodes4.empty() && nodes8.empty();
+}
+
+int WideBVH::width() const
+{
+    return _width;
+}
+
+size_t WideBVH::num_nodes() const
+{
+    return nodes4.size() + nodes8.size();
+}
+
+int WideBVH::depth() const
+{
+    return _depth;
+}
+
+NODE_TEST WideBVH::node_test() const
+{
+    return test;
+}
+
+size_t WideBVH::memory_bytes() const
+{
+    return nodes4.capacity() * sizeof(wide_bvh_node<4>) + nodes8.capacity() * sizeof(wide_bvh_node<8>);
+}
+
+string WideBVH::description() const
+{
+    size_t node_bytes = (_width == 8) ? sizeof(wide_bvh_node<8>) : sizeof(wide_bvh_node<4>);
+
+    return std::to_string(_width) + "-wide, " + std::to_string(num_nodes()) + " nodes of " + std::to_string(node_bytes) + " bytes, depth "
+        + std::to_string(_depth) + ", " + node_test_name(test) + " node test, nearest child first";
+}
+
+string WideBVH::node_test_name(NODE_TEST test)
+{
+    switch (test)
+    {
+    case SSE_NODE_TEST: return "SSE";
+    case AVX2_NODE_TEST: return "AVX2";
+    default: return "Scalar";
+    }
+}
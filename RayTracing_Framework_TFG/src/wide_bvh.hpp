@@ -0,0 +1,159 @@
+﻿#pragma once
+
+// Headers
+#include "core.hpp"
+#include "ray.hpp"
+#include "interval.hpp"
+#include "ray_stats.hpp"
+
+// Forward declarations
+struct linear_bvh_node;
+
+// Macros
+constexpr int wide_bvh_max_width = 8;
+constexpr int wide_bvh_max_depth = 64;
+constexpr int wide_bvh_stack_size = wide_bvh_max_depth * (wide_bvh_max_width - 1) + 1;      // Every visited node adds at most width - 1 entries
+constexpr float wide_bvh_exit_scale = 1.0f + 4 * std::numeric_limits<float>::epsilon();    // Covers the rounding of the single precision slab distances
+
+enum NODE_TEST
+{
+    SCALAR_NODE_TEST,   // One child box after the other
+    SSE_NODE_TEST,      // Four child boxes per 128-bit instruction sequence
+    AVX2_NODE_TEST      // Eight child boxes per 256-bit instruction sequence
+};
+
+template <int width>
+struct alignas(64) wide_bvh_node // Node of a collapsed BVH with the boxes of its children stored as structure of arrays, one SIMD lane per child
+{
+    float bounds[6][width];     // Minimum x, y, z then maximum x, y, z of every child. Empty slots hold inverted boxes that no ray enters.
+    uint32_t child[width];      // Interior child: index of its node. Leaf child: first primitive.
+    uint16_t count[width];      // Primitives of a leaf child, 0 for interior children and empty slots
+};
+
+struct wide_bvh_ray // Ray prepared once for the single precision slab tests of all the wide nodes it visits
+{
+    float near_origin[3];       // Origin rounded so that the entry distances only ever come out too small...
+    float far_origin[3];        // ...and the exit distances only ever too large
+    float inverse_direction[3];
+    int near_plane[3];          // Row of wide_bvh_node::bounds holding the entry plane of each axis
+    int far_plane[3];
+
+    wide_bvh_ray(const Ray& r);
+};
+
+// Tests the ray against the boxes of all the children of a node between t_min and t_max. Writes the entry distance of
+// every child and returns the mask of the children the ray enters. Rounding can only report a box as hit, never as missed.
+template <int width>
+using wide_bvh_node_test = uint32_t(*)(const wide_bvh_node<width>& node, const wide_bvh_ray& ray, float t_min, float t_max, float* t_near);
+
+class WideBVH // Copy of a flat binary BVH collapsed into nodes of 4 or 8 children, traversed nearest child first
+{
+public:
+    // Collapses the binary nodes, keeping their leaves and primitive order. The node test is the widest one the CPU
+    // supports, or the scalar one when simd is off.
+    void build(const vector<linear_bvh_node>& binary_nodes, int width, bool simd = true);
+
+    // Calls hit_leaf(first, count, ray_t) for the leaves the ray enters, nearest first. hit_leaf returns whether it
+    // found a hit and lowers ray_t.max to it, which culls the children behind it.
+    template <typename HitLeaf>
+    bool hit(const Ray& r, Interval ray_t, HitLeaf&& hit_leaf) const;
+
+    bool empty() const;
+    int width() const;
+    size_t num_nodes() const;
+    int depth() const;
+    NODE_TEST node_test() const;
+    size_t memory_bytes() const;
+    string description() const;
+
+    static string node_test_name(NODE_TEST test);
+
+private:
+    int _width = 0;
+    int _depth = 0;
+    NODE_TEST test = SCALAR_NODE_TEST;
+    vector<wide_bvh_node<4>> nodes4;
+    vector<wide_bvh_node<8>> nodes8;
+    wide_bvh_node_test<4> test4 = nullptr;
+    wide_bvh_node_test<8> test8 = nullptr;
+
+    template <int node_width>
+    uint32_t collapse(vector<wide_bvh_node<node_width>>& nodes, const vector<linear_bvh_node>& binary_nodes, uint32_t binary_index, int node_depth);
+
+    template <int node_width, typename HitLeaf>
+    static bool traverse(const vector<wide_bvh_node<node_width>>& nodes, wide_bvh_node_test<node_width> node_test, const Ray& r, Interval& ray_t, HitLeaf& hit_leaf);
+};
+
+template <typename HitLeaf>
+bool WideBVH::hit(const Ray& r, Interval ray_t, HitLeaf&& hit_leaf) const
+{
+    if (_width == 8)
+        return traverse(nodes8, test8, r, ray_t, hit_leaf);
+
+    return traverse(nodes4, test4, r, ray_t, hit_leaf);
+}
+
+template <int node_width, typename HitLeaf>
+bool WideBVH::traverse(const vector<wide_bvh_node<node_width>>& nodes, wide_bvh_node_test<node_width> node_test, const Ray& r, Interval& ray_t, HitLeaf& hit_leaf)
+{
+    if (nodes.empty())
+        return false;
+
+    RayStats& stats = RayStats::local();
+    wide_bvh_ray ray(r);
+
+    // Children waiting to be visited with the distance at which the ray enters them, the nearest one on top
+    struct StackEntry
+    {
+        uint32_t child;
+        uint32_t count;
+        float t_near;
+    };
+
+    StackEntry stack[wide_bvh_stack_size];
+    int stack_size = 0;
+    stack[stack_size++] = { 0, 0, float(ray_t.min) };
+    bool hit_anything = false;
+
+    while (stack_size > 0)
+    {
+        StackEntry entry = stack[--stack_size];
+
+        // A hit found after the child was pushed may lie in front of it
+        if (entry.t_near > ray_t.max * wide_bvh_exit_scale)
+            continue;
+
+        if (entry.count > 0)
+        {
+            if (hit_leaf(entry.child, entry.count, ray_t))
+                hit_anything = true;
+
+            continue;
+        }
+
+        const wide_bvh_node<node_width>& node = nodes[entry.child];
+        stats.bvh_nodes_visited++;
+
+        alignas(32) float t_near[node_width];
+        uint32_t mask = node_test(node, ray, float(ray_t.min), float(ray_t.max), t_near);
+
+        // Insert the children the ray enters sorted by descending entry distance, so the nearest one is popped first
+        int first = stack_size;
+
+        while (mask != 0)
+        {
+            int slot = std::countr_zero(mask);
+            mask &= mask - 1;
+
+            StackEntry child = { node.child[slot], node.count[slot], t_near[slot] };
+            int i = stack_size++;
+
+            for (; i > first && stack[i - 1].t_near < child.t_near; i--)
+                stack[i] = stack[i - 1];
+
+            stack[i] = child;
+        }
+    }
+
+    return hit_anything;
+}